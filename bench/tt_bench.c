@@ -0,0 +1,312 @@
+// Headless benchmark for the tracker core: builds synthetic timelines and times
+// what the app does at startup, per edit and per frame, so regressions show up
+// as numbers instead of as a sluggish window.
+//
+//   cc -O2 -o tt_bench bench/tt_bench.c tt_core.c -lm -lpthread
+//   ./tt_bench [max_events] [overlap] [desc_len]
+//
+// Sizes go 1k, 10k, ... up to max_events (default 1M; 10M needs a few GB of RAM).
+// overlap is how many events cover an average instant (default 2), desc_len the
+// length of every description (default 40). Files go to $TMPDIR or /tmp.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../tt_core.h"
+
+#define BENCH_BUDGET_SECS 2.0   // latency loops stop early once they've run this long
+#define BENCH_SAMPLES     2000
+#define SCREEN_W          1500.0f
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t NextRandom(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double UniformRandom(void) { return (NextRandom() >> 11) * (1.0 / 9007199254740992.0); }
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Synthetic timelines – starts spread evenly over a span sized so that `overlap`
+// events cover an average instant; durations are exponential around a day
+// ─────────────────────────────────────────────────────────────────────────────
+#define MEAN_DURATION 86400.0
+#define TIMELINE_BASE ((time_t)946684800)   // 2000-01-01
+
+static time_t timeline_span;
+
+static void RandomText(char *out, int len)
+{
+    for (int k = 0; k < len; k++) {
+        uint64_t r = NextRandom();
+        out[k] = (r % 6 == 0 && k > 0 && out[k-1] != ' ') ? ' ' : (char)('a' + (r >> 8) % 26);
+    }
+    out[len] = '\0';
+}
+
+static void Generate(int n, double overlap, int desc_len)
+{
+    TrackerClear();
+    timeline_span = (time_t)(n * MEAN_DURATION / overlap) + 1;
+
+    char name[32], *desc = malloc(desc_len + 1);
+    if (!desc) return;
+    for (int k = 0; k < n; k++) {
+        time_t s = TIMELINE_BASE + (time_t)(UniformRandom() * timeline_span);
+        time_t d = (time_t)(-log(1.0 - UniformRandom()) * MEAN_DURATION) + 60;
+        snprintf(name, sizeof(name), "Event %d", k);
+        RandomText(desc, desc_len);
+        if (TrackerAdd(name, desc, s, s + d) < 0) break;
+    }
+    free(desc);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reporting
+// ─────────────────────────────────────────────────────────────────────────────
+static void ReportBulk(int n, const char *op, double secs, double bytes)
+{
+    printf("%9d  %-14s %10.1f ms  %12.0f ev/s", n, op, secs * 1e3, n / secs);
+    if (bytes > 0) printf("  %8.1f MB/s", bytes / secs / 1e6);
+    printf("\n");
+}
+
+static void ReportLatency(int n, const char *op, double *samples, int count, double extra, const char *extra_unit)
+{
+    if (count == 0) return;
+    qsort(samples, count, sizeof(double), CompareDouble);
+    printf("%9d  %-14s p50 %9.2f us  p99 %9.2f us  max %9.2f us", n, op,
+           samples[count / 2] * 1e6, samples[(int)(count * 0.99)] * 1e6, samples[count - 1] * 1e6);
+    if (extra_unit) printf("  %10.1f %s", extra, extra_unit);
+    printf("\n");
+}
+
+static double FileSize(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (double)st.st_size : 0.0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Benchmarks
+// ─────────────────────────────────────────────────────────────────────────────
+static double samples[BENCH_SAMPLES];
+
+// Full sort + track layout from scratch, as after a load
+static void BenchLayout(int n)
+{
+    IndexMarkDirty();
+    double t0 = Now();
+    IndexEnsure();
+    ReportBulk(n, "layout", Now() - t0, 0);
+
+    // The pyramid waits for the first zoomed-out frame
+    t0 = Now();
+    LodLevelFor(1e6);
+    ReportBulk(n, "lod build", Now() - t0, 0);
+}
+
+// One event nudged, as a drag frame does: re-sort it and re-stack its clusters
+static void BenchEdit(int n)
+{
+    int count = 0;
+    double begin = Now();
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        int i = (int)(NextRandom() % (uint64_t)n);
+        time_t shift = (time_t)((UniformRandom() - 0.5) * 4 * 3600);
+        double t0 = Now();
+        tracker.start[i] += shift;
+        tracker.end[i]   += shift;
+        IndexMoved(i);
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, "edit", samples, count, 0, NULL);
+}
+
+// One screen's worth of events, with the LOD cut-off DrawEvents uses at this zoom
+static void BenchQuery(int n, double pixels_per_year, const char *op)
+{
+    double secs_per_px = (365.25 * 86400.0) / pixels_per_year;
+    time_t width = (time_t)(SCREEN_W * secs_per_px);
+    int level = LodLevelFor(secs_per_px);
+    time_t min_len = level >= 0 ? LodBucketSecs(level) : 0;
+
+    int count = 0;
+    double hits = 0, begin = Now();
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        time_t from = TIMELINE_BASE + (time_t)(UniformRandom() * timeline_span) - width / 2;
+        double t0 = Now();
+        hits += IndexQuery(from, from + width, min_len);
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, op, samples, count, count ? hits / count : 0, "hits");
+}
+
+// The hover test under the mouse at the default zoom
+static void BenchPick(int n)
+{
+    TimelineView view = { 0, 700.0, SCREEN_W, 300.0f, 10.0f };
+    double secs_per_px = (365.25 * 86400.0) / view.pixels_per_year;
+
+    int count = 0, found = 0;
+    double begin = Now();
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        view.view_start = TIMELINE_BASE + (time_t)(UniformRandom() * timeline_span) - (time_t)(SCREEN_W / 2 * secs_per_px);
+        float x = (float)(UniformRandom() * SCREEN_W);
+        float y = view.rows_y + (float)(NextRandom() % 8) * view.row_spacing;
+        double t0 = Now();
+        found += EventPick(&view, x, y) >= 0;
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, "pick", samples, count, count ? 100.0 * found / count : 0, "% hit");
+}
+
+// Index build, then what each keystroke in the search box costs: a piece of
+// some description, first screenful of matches. 1-2 bytes is what the first
+// keystrokes send; "#" and "#!" never match, the worst case for those
+static void BenchSearchLatency(int n, int desc_len, int min_len, int max_len, const char *op)
+{
+    int hits[21], count = 0;
+    double found = 0, begin = Now();
+    char q[9];
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        const char *d = EventDesc((int)(NextRandom() % (uint64_t)n));
+        int len = min_len + (int)(NextRandom() % (uint64_t)(max_len - min_len + 1));
+        if (len > desc_len) len = desc_len;
+        memcpy(q, d + NextRandom() % (uint64_t)(desc_len - len + 1), len);
+        q[len] = '\0';
+        double t0 = Now();
+        found += SearchQuery(q, hits, 21);
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, op, samples, count, count ? found / count : 0, "hits");
+}
+
+static void BenchSearch(int n, int desc_len)
+{
+    double t0 = Now();
+    SearchEnsure();
+    ReportBulk(n, "search build", Now() - t0, 0);
+    if (desc_len < 3) return;
+    BenchSearchLatency(n, desc_len, 1, 2, "search 1-2");
+    BenchSearchLatency(n, desc_len, 3, 8, "search 3-8");
+
+    int hits[21], count = 0;
+    double begin = Now();
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        t0 = Now();
+        SearchQuery(count % 2 ? "#!" : "#", hits, 21);
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, "search miss", samples, count, 0, NULL);
+}
+
+// The command-line queries over a random month, output thrown away
+static void BenchCliQuery(int n, FILE *null, int (*query)(FILE*, time_t, time_t, bool), const char *op)
+{
+    int count = 0;
+    double rows = 0, begin = Now();
+    while (count < BENCH_SAMPLES && Now() - begin < BENCH_BUDGET_SECS) {
+        time_t from = TIMELINE_BASE + (time_t)(UniformRandom() * timeline_span) - 15 * 86400;
+        double t0 = Now();
+        rows += query(null, from, from + 30 * 86400, false);
+        samples[count++] = Now() - t0;
+    }
+    ReportLatency(n, op, samples, count, count ? rows / count : 0, "rows");
+}
+
+static void BenchCli(int n)
+{
+    FILE *null = fopen("/dev/null", "w");
+    if (!null) return;
+    BenchCliQuery(n, null, QueryEvents, "cli events");
+    BenchCliQuery(n, null, QueryTotals, "cli totals");
+    BenchCliQuery(n, null, QueryConflicts, "cli conflicts");
+    fclose(null);
+}
+
+static void BenchSaveLoad(int n, const char *path)
+{
+    double t0 = Now();
+    SaveTracker(path);
+    double secs = Now() - t0;
+    double bytes = FileSize(path);
+    ReportBulk(n, "save json", secs, bytes);
+
+    t0 = Now();
+    LoadTracker(path);
+    ReportBulk(n, "load json", Now() - t0, bytes);
+
+    // Startup through the snapshot: the first LoadTimeline writes it, the second reads it
+    char snap[1100], journal[1100];
+    snprintf(snap, sizeof(snap), "%s.snap", path);
+    snprintf(journal, sizeof(journal), "%s.journal", path);
+    remove(snap);
+    LoadTimeline(path);
+    CloseTimeline();
+    t0 = Now();
+    LoadTimeline(path);
+    ReportBulk(n, "load snapshot", Now() - t0, FileSize(snap));
+    CloseTimeline();
+
+    if (tracker.count != n) fprintf(stderr, "round trip kept %d of %d events\n", tracker.count, n);
+    remove(path);
+    remove(snap);
+    remove(journal);
+}
+
+int main(int argc, char **argv)
+{
+    long max_events = argc > 1 ? atol(argv[1]) : 1000000;
+    double overlap  = argc > 2 ? atof(argv[2]) : 2.0;
+    int desc_len    = argc > 3 ? atoi(argv[3]) : 40;
+    if (max_events < 1000 || overlap <= 0.0 || desc_len < 0) {
+        fprintf(stderr, "usage: %s [max_events >= 1000] [overlap > 0] [desc_len >= 0]\n", argv[0]);
+        return 1;
+    }
+
+    const char *dir = getenv("TMPDIR");
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/tt_bench_%d.json", dir && *dir ? dir : "/tmp", (int)getpid());
+
+    printf("overlap %.1f, descriptions %d bytes\n", overlap, desc_len);
+    printf("%9s  %-14s %s\n", "events", "operation", "result");
+    for (long n = 1000; n <= max_events; n *= 10) {
+        Generate((int)n, overlap, desc_len);
+        if (tracker.count != n) { fprintf(stderr, "out of memory at %ld events\n", n); return 1; }
+        BenchLayout((int)n);
+        BenchQuery((int)n, 700.0, "query 700px/y");
+        BenchQuery((int)n, 20.0, "query 20px/y");
+        BenchPick((int)n);
+        BenchSearch((int)n, desc_len);
+        BenchEdit((int)n);
+        BenchCli((int)n);
+        BenchSaveLoad((int)n, path);
+        fflush(stdout);
+    }
+    TrackerClear();
+    return 0;
+}
@@ -1,33 +1,34 @@
 #define _GNU_SOURCE
   #include <raylib.h>
+  #include <rlgl.h>
   #include <stdio.h>
   #include <stdlib.h>
+  #include <stdint.h>
   #include <string.h>
   #include <time.h>
   #include <math.h>          // ← THIS WAS MISSING
+
+  #include "tt_core.h"
   
-  #define MAX_ENTRIES 1000
-  #define MAX_NAME    256
   #define MAX_INPUT   1024
   #define EDGE_GRAB   20
-  #define MAX_DESC    1024
-  
-  typedef struct { char name[MAX_NAME]; time_t start, end; double duration_years; Color color; char description[MAX_DESC]; } Entry;
-  typedef struct { Entry entries[MAX_ENTRIES]; int count; time_t view_start; double pixels_per_year; } Tracker;
   
   typedef struct {
       char text[MAX_INPUT];
       int cursor_pos;
       Rectangle rect;
       bool active;
+      // Per codepoint: where it starts in text, and the unscaled advance sum before it
+      int   cp_count;
+      int   cp_byte[MAX_INPUT + 1];
+      float cp_x[MAX_INPUT + 1];
   } TextInput;
   
   // ─────────────────────────────────────────────────────────────────────────────
   // Global state
   // ─────────────────────────────────────────────────────────────────────────────
   static Font font;
-  static Tracker tracker = {0};
-  static TextInput name_input, start_input, end_input, desc_input;
+  static TextInput name_input, start_input, end_input, desc_input, search_input;
   static int selected = -1;
   static int dragging = -1;
   static int drag_mode = 0;
@@ -38,19 +39,29 @@
   static const float events_start_y = timeline_y + 160.0f;   // ← YOUR desired offset
   
   static time_t original_duration = 0;
-  static int    g_track_of_event[1024] = {0};
   static double secs_per_pixel = 0.0;
-  static time_t track_free_until[50];
   static bool clicked_on_event_this_frame = false;
   static bool  g_show_tooltip = false;
-  static char  g_tooltip_text[512];
+  static const char *g_tooltip_text = "";   // points into the store; valid for the frame it was set in
   static float g_tooltip_x, g_tooltip_y;
+
+  // What DrawTimelineGrid and DrawEvents draw into: the window, or while an
+  // export renders, one tile wide and the whole image tall, of which only rows
+  // [top, bottom) are being rendered (see Export)
+  static struct { bool active; int width, height, top, bottom; } export_canvas;
+  static int CanvasWidth(void)  { return export_canvas.active ? export_canvas.width  : GetScreenWidth(); }
+  static int CanvasHeight(void) { return export_canvas.active ? export_canvas.height : GetScreenHeight(); }
   
   #define EDGE_GRAB_PIXELS 16.0f   // use this instead of EDGE_GRAB to avoid conflict
   // ─────────────────────────────────────────────────────────────────────────────
   void DrawTextInput(TextInput *ti, Font font);
   void UpdateTextInput(TextInput *ti, Font font);
+  static void TextInputReflow(TextInput *ti);
+  bool SearchOwnsMouse(void);
+  bool LayerChipsOwnMouse(void);
+  void ExportTimeline(void);
   
+
   // ─────────────────────────────────────────────────────────────────────────────
   // Helper Functions
   // ─────────────────────────────────────────────────────────────────────────────
@@ -58,117 +69,47 @@
       ti->rect = r; ti->active = false; ti->cursor_pos = 0;
       strncpy(ti->text, initial ? initial : "", MAX_INPUT-1);
       ti->text[MAX_INPUT-1] = '\0';
+      TextInputReflow(ti);
   }
   
-  time_t ParseDateTime(const char *s) {
-      struct tm tm = {0};
-      if (strptime(s, "%Y-%m-%d %H:%M", &tm) || strptime(s, "%Y-%m-%d", &tm))
-          return mktime(&tm);
-      return 0;
-  }
-  
-// ─────────────────────────────────────────────────────────────────────────────
-// SAVE: now safely escapes quotes and writes full Unicode names/descriptions
-// ─────────────────────────────────────────────────────────────────────────────
-void SaveTracker(const char *file)
-{
-    FILE *f = fopen(file, "w");
-    if (!f) return;
-
-    fprintf(f, "[\n");
-    for (int i = 0; i < tracker.count; i++) {
-        char s1[64], s2[64];
-        strftime(s1, sizeof(s1), "%Y-%m-%d %H:%M", localtime(&tracker.entries[i].start));
-        strftime(s2, sizeof(s2), "%Y-%m-%d %H:%M", localtime(&tracker.entries[i].end));
-
-        // Properly escape " in name and description
-        char name_esc[512] = {0};
-        char desc_esc[2048] = {0};
-        for (int j = 0, k = 0; tracker.entries[i].name[j] && k < 510; j++) {
-            if (tracker.entries[i].name[j] == '"') name_esc[k++] = '\\';
-            name_esc[k++] = tracker.entries[i].name[j];
-        }
-        for (int j = 0, k = 0; tracker.entries[i].description[j] && k < 2046; j++) {
-            if (tracker.entries[i].description[j] == '"') desc_esc[k++] = '\\';
-            desc_esc[k++] = tracker.entries[i].description[j];
-        }
-
-        fprintf(f, "  {\"name\":\"%s\",\"start\":\"%s\",\"end\":\"%s\",\"desc\":\"%s\"}%s\n",
-                name_esc, s1, s2, desc_esc,
-                (i < tracker.count-1) ? "," : "");
-    }
-    fprintf(f, "]\n");
-    fclose(f);
-}
-
-// ─────────────────────────────────────────────────────────────────────────────
-// LOAD: now reads any length (no fixed 63-char limit) → works with Unicode
-// ─────────────────────────────────────────────────────────────────────────────
-void LoadTracker(const char *file)
-{
-    FILE *f = fopen(file, "r");
-    if (!f) return;
-
-    char line[4096];
-    tracker.count = 0;
-
-    while (fgets(line, sizeof(line), f) && tracker.count < MAX_ENTRIES) {
-        char name[512] = {0};
-        char start_str[64] = {0};
-        char end_str[64] = {0};
-        char desc[2048] = {0};
-
-        // Flexible parsing – no hard 63-char limit anymore
-        int n = sscanf(line,
-            "  {\"name\":\"%511[^\"]\",\"start\":\"%63[^\"]\",\"end\":\"%63[^\"]\",\"desc\":\"%2047[^\"]\"}",
-            name, start_str, end_str, desc);
-
-        if (n < 3) {
-            // Try without description
-            n = sscanf(line,
-                "  {\"name\":\"%511[^\"]\",\"start\":\"%63[^\"]\",\"end\":\"%63[^\"]\"}",
-                name, start_str, end_str);
-            if (n < 3) continue;
-        }
-
-        time_t s = ParseDateTime(start_str);
-        time_t e = ParseDateTime(end_str);
-        if (!s || e <= s) continue;
-
-        Entry *en = &tracker.entries[tracker.count++];
-        strncpy(en->name, name, MAX_NAME-1);
-        en->name[MAX_NAME-1] = '\0';
-        strncpy(en->description, desc, 511);
-        en->description[511] = '\0';
-        en->start = s;
-        en->end = e;
-        en->duration_years = difftime(e, s) / (365.25*86400.0);
-        en->color = (Color){GetRandomValue(90,230), GetRandomValue(90,230), GetRandomValue(110,240), 255};
-    }
-    fclose(f);
-}
   
   void SyncInputsToSelected(void) {
       if (selected < 0 || selected >= tracker.count) return;
-      Entry *e = &tracker.entries[selected];
-      strncpy(name_input.text, e->name, MAX_INPUT-1); name_input.text[MAX_INPUT-1] = '\0';
-      strncpy(desc_input.text, e->description, MAX_INPUT-1); desc_input.text[MAX_INPUT-1] = '\0';
-      strftime(start_input.text, MAX_INPUT, "%Y-%m-%d", localtime(&e->start));
-      strftime(end_input.text,   MAX_INPUT, "%Y-%m-%d", localtime(&e->end));
+      strncpy(name_input.text, EventName(selected), MAX_INPUT-1); name_input.text[MAX_INPUT-1] = '\0';
+      strncpy(desc_input.text, EventDesc(selected), MAX_INPUT-1); desc_input.text[MAX_INPUT-1] = '\0';
+      strftime(start_input.text, MAX_INPUT, "%Y-%m-%d", localtime(&tracker.start[selected]));
+      strftime(end_input.text,   MAX_INPUT, "%Y-%m-%d", localtime(&tracker.end[selected]));
+      TextInputReflow(&name_input);
+      TextInputReflow(&desc_input);
+      TextInputReflow(&start_input);
+      TextInputReflow(&end_input);
   }
   
+  // A date field still showing the event's own day leaves its time of day alone
+  static time_t InputTime(const TextInput *ti, time_t current) {
+      char shown[MAX_INPUT];
+      strftime(shown, sizeof(shown), "%Y-%m-%d", localtime(&current));
+      return strcmp(ti->text, shown) ? ParseDateTime(ti->text) : current;
+  }
+
   void ApplyInputsToSelected(void) {
-      if (selected < 0 || selected >= tracker.count) return;
-      Entry *e = &tracker.entries[selected];
-      time_t s = ParseDateTime(start_input.text);
-      time_t e_time = ParseDateTime(end_input.text);
+      if (selected < 0 || selected >= tracker.editable) return;   // overlay events are read-only
+      time_t s = InputTime(&start_input, tracker.start[selected]);
+      time_t e_time = InputTime(&end_input, tracker.end[selected]);
       if (s && e_time > s) {
-          strncpy(e->name, name_input.text[0] ? name_input.text : "Untitled", MAX_NAME-1);
-          strncpy(e->description, desc_input.text, 511);
-          e->description[511] = '\0';
-          e->start = s;
-          e->end = e_time;
-          e->duration_years = difftime(e->end, e->start) / (365.25*86400);
+          const char *name = name_input.text[0] ? name_input.text : "Untitled";
+          bool text_changed = strcmp(EventName(selected), name) || strcmp(EventDesc(selected), desc_input.text);
+          bool moved = tracker.start[selected] != s || tracker.end[selected] != e_time;
+          if (!text_changed && !moved) return;
+
+          HistoryEditing(selected);   // typing stays one undo step until the selection changes
+          TrackerSetText(selected, name, desc_input.text);
+          if (moved) {
+              tracker.start[selected] = s;
+              tracker.end[selected]   = e_time;
+              IndexMoved(selected);
+          }
+          JournalSet(selected);
       }
   }
   
@@ -249,27 +190,35 @@ void HandlePanningAndZooming(void)
   
       Vector2 mouse = GetMousePosition();
       time_t cursor_time = tracker.view_start + (time_t)((mouse.x - 0.0f) * secs_per_pixel);
-      Entry *e = &tracker.entries[dragging];        // ← fixed: added ]
+      time_t *start = &tracker.start[dragging], *end = &tracker.end[dragging];
+      static bool moved = false;   // only a drag that changed something gets journaled
   
       if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+          time_t old_start = *start, old_end = *end;
           if (drag_mode == 0) {
-              e->start = cursor_time + drag_offset;
-              e->end   = e->start + original_duration;
+              *start = cursor_time + drag_offset;
+              *end   = *start + original_duration;
           }
           else if (drag_mode == 1) {
               time_t ns = cursor_time + drag_offset;
-              if (ns < e->end - 86400) e->start = ns;
+              if (ns < *end - 86400) *start = ns;
           }
           else if (drag_mode == 2) {
               time_t ne = cursor_time + drag_offset;
-              if (ne > e->start + 86400) e->end = ne;
+              if (ne > *start + 86400) *end = ne;
+          }
+          if (*start != old_start || *end != old_end) {
+              IndexMoved(dragging);
+              moved = true;
           }
   
-          e->duration_years = difftime(e->end, e->start) / (365.25 * 86400.0);
           if (selected == dragging) SyncInputsToSelected();
       }
   
       if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+          if (moved) JournalSet(dragging);
+          HistoryFlush();   // the whole drag is one undo step
+          moved = false;
           dragging = -1;
           drag_mode = 0;
           original_duration = 0;
@@ -278,6 +227,7 @@ void HandlePanningAndZooming(void)
   }
   
   void HandleKeyboardShortcuts(void) {
+      if (search_input.active) return;   // Enter and Delete belong to the search box then
       if (IsKeyPressed(KEY_ENTER) && selected == -1) {
           time_t s = 0, e = 0;
   
@@ -295,30 +245,36 @@ void HandlePanningAndZooming(void)
               e = s + 365*86400;  // default: +1 year
           }
   
-          if (tracker.count < MAX_ENTRIES) {
-              Entry *en = &tracker.entries[tracker.count++];
-              strncpy(en->name, name_input.text[0] ? name_input.text : "Untitled", MAX_NAME-1);
-              en->name[MAX_NAME-1] = '\0';
-              strncpy(en->description, desc_input.text, 511);
-              en->description[511] = '\0';           // ← Fixed: now 511 (was 255)
-              en->start = s;
-              en->end   = e;
-              en->duration_years = difftime(e, s) / (365.25*86400);
-              en->color = (Color){GetRandomValue(90,230), GetRandomValue(90,230), GetRandomValue(110,240), 255};
-              
-              selected = tracker.count - 1;
+          int idx = TrackerAdd(name_input.text[0] ? name_input.text : "Untitled", desc_input.text, s, e);
+          if (idx >= 0) {
+              JournalAdd(idx);
+              HistoryAdded(idx);
+              selected = idx;
               SyncInputsToSelected();
               last_selected = -2;
           }
       }
   
-      if (IsKeyPressed(KEY_DELETE) && selected >= 0) {
-          memmove(&tracker.entries[selected], &tracker.entries[selected+1],
-                  sizeof(Entry) * (tracker.count - selected - 1));
-          tracker.count--; 
+      if (IsKeyPressed(KEY_DELETE) && selected >= 0 && selected < tracker.editable) {
+          HistoryRemoving(selected);
+          JournalDelete(selected);
+          TrackerRemove(selected);
           selected = -1; 
           last_selected = -2;
       }
+
+      // Ctrl+Z undo, Ctrl+Y / Ctrl+Shift+Z redo; the event that changed gets selected
+      bool ctrl  = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+      bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+      int touched;
+      if (ctrl && dragging == -1 &&
+          ((IsKeyPressed(KEY_Z) && !shift && HistoryUndo(&touched)) ||
+           ((IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift)) && HistoryRedo(&touched)))) {
+          selected = touched;
+          last_selected = -2;
+      }
+
+      if (IsKeyPressed(KEY_F6) && dragging == -1) ExportTimeline();
   }
   
   // ─────────────────────────────────────────────────────────────────────────────
@@ -331,10 +287,14 @@ void HandlePanningAndZooming(void)
       return &tm_buf;
   }
   
+  static const char *MONTH_ABBR[12] = {
+      "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
   void DrawTimelineGrid(void)
   {
       const float left       = 0.0f;
-      const float right      = GetScreenWidth();
+      const float right      = CanvasWidth();
       const float baseline_y = 260.0f;
   
       double secs_per_pixel = (365.25 * 86400.0) / tracker.pixels_per_year;
@@ -345,19 +305,16 @@ void HandlePanningAndZooming(void)
                  3.0f, (Color){90, 90, 140, 255});
   
       /* ────────────────────── TODAY LINE ────────────────────── */
-      time_t now = time(NULL);
-      struct tm today = {0};
-      localtime_r(&now, &today);
-      today.tm_hour = today.tm_min = today.tm_sec = 0;
-      today.tm_isdst = -1;
-      time_t today_midnight = mktime(&today);
+      int today_y, today_m, today_d;
+      LocalCivil(time(NULL), &today_y, &today_m, &today_d);
+      time_t today_midnight = LocalFromCivil(today_y, today_m, today_d, 0, 0);
   
       double secs = difftime(today_midnight, tracker.view_start);
       float tx = left + (float)(secs / secs_per_pixel);
   
       if (tx >= left - 200 && tx <= right + 200)
       {
-          DrawLineEx((Vector2){tx, baseline_y - 60}, (Vector2){tx, GetScreenHeight() - 50},
+          DrawLineEx((Vector2){tx, baseline_y - 60}, (Vector2){tx, CanvasHeight() - 50},
                      4.5f, RED);
           DrawCircle(tx, baseline_y, 10, RED);
           DrawCircle(tx, baseline_y, 7, (Color){40,10,10,255});
@@ -367,25 +324,15 @@ void HandlePanningAndZooming(void)
   /* ────────────────────── VERTICAL YEAR LABELS – FULL YYYY + CLEAN SPACING ────────────────────── */
   if (tracker.pixels_per_year > 30.0f)
   {
-      struct tm start_tm = {0};
-      localtime_r(&tracker.view_start, &start_tm);
-      start_tm.tm_year -= 50;
-      start_tm.tm_mon = 0;
-      start_tm.tm_mday = 1;
-      start_tm.tm_isdst = -1;
-      mktime(&start_tm);
-      int year = start_tm.tm_year + 1900;
-  
-      int end_year = SafeLocalTime(&view_end)->tm_year + 1900 + 50;
+      int year, end_year, mon, day;
+      LocalCivil(tracker.view_start, &year, &mon, &day);
+      LocalCivil(view_end, &end_year, &mon, &day);
+      year -= 50;
+      end_year += 50;
   
       for (; year <= end_year; ++year)
       {
-          struct tm ytm = {0};
-          ytm.tm_year = year - 1900;
-          ytm.tm_mon  = 0;
-          ytm.tm_mday = 1;
-          ytm.tm_isdst = -1;
-          time_t yt = mktime(&ytm);
+          time_t yt = LocalFromCivil(year, 1, 1, 0, 0);
   
           double secs = difftime(yt, tracker.view_start);
           float x = left + (float)(secs / secs_per_pixel);
@@ -417,18 +364,14 @@ void HandlePanningAndZooming(void)
       /* ────────────────────── MONTH & DAY GRIDS (unchanged) ────────────────────── */
       if (tracker.pixels_per_year > 250.0f)
       {
-          struct tm tmp = {0};
-          localtime_r(&tracker.view_start, &tmp);
-          tmp.tm_mday = 1;
-          tmp.tm_hour = tmp.tm_min = tmp.tm_sec = 0;
-          tmp.tm_isdst = -1;
-          time_t t = mktime(&tmp);
+          int year, mon, day;
+          LocalCivil(tracker.view_start, &year, &mon, &day);
+          time_t t = LocalFromCivil(year, mon, 1, 0, 0);
   
           if (t < tracker.view_start)
           {
-              if (++tmp.tm_mon >= 12) { tmp.tm_mon = 0; tmp.tm_year++; }
-              tmp.tm_isdst = -1;
-              t = mktime(&tmp);
+              if (++mon > 12) { mon = 1; year++; }
+              t = LocalFromCivil(year, mon, 1, 0, 0);
           }
   
           while (t < view_end + 86400LL*60)
@@ -438,39 +381,32 @@ void HandlePanningAndZooming(void)
   
               if (x >= left - 200 && x <= right + 200)
               {
-                  struct tm *mtm = SafeLocalTime(&t);
-                  float thickness = (mtm->tm_mon == 0) ? 2.8f : 1.9f;
-                  float height_up = (mtm->tm_mon == 0) ? 22 : 15;
-                  Color col = (mtm->tm_mon == 0) ? Fade(WHITE, 0.95f) : Fade(WHITE, 0.65f);
+                  float thickness = (mon == 1) ? 2.8f : 1.9f;
+                  float height_up = (mon == 1) ? 22 : 15;
+                  Color col = (mon == 1) ? Fade(WHITE, 0.95f) : Fade(WHITE, 0.65f);
   
                   DrawLineEx((Vector2){x, baseline_y - height_up},
                              (Vector2){x, baseline_y + 14}, thickness, col);
   
-                  char label[16];
-                  strftime(label, sizeof(label), "%b", mtm);
+                  const char *label = MONTH_ABBR[mon - 1];
                   DrawTextPro(font, label,
                               (Vector2){x + 10, baseline_y - 65},
                               (Vector2){0,0}, 90.0f, 17, 1.2f, Fade(WHITE, 0.9f));
               }
   
-              if (++tmp.tm_mon >= 12) { tmp.tm_mon = 0; tmp.tm_year++; }
-              tmp.tm_mday = 1;
-              tmp.tm_isdst = -1;
-              t = mktime(&tmp);
+              if (++mon > 12) { mon = 1; year++; }
+              t = LocalFromCivil(year, mon, 1, 0, 0);
           }
       }
   
       if (tracker.pixels_per_year > 3000.0f)
       {
-          struct tm tmp = {0};
-          localtime_r(&tracker.view_start, &tmp);
-          tmp.tm_hour = tmp.tm_min = tmp.tm_sec = 0;
-          tmp.tm_isdst = -1;
-          time_t t = mktime(&tmp);
+          int year, mon, day;
+          int64_t z = LocalCivil(tracker.view_start, &year, &mon, &day);   // day number
+          time_t t = UtcFromLocal(z * 86400);
         if (t < tracker.view_start) {
-            tmp.tm_mday++;
-            tmp.tm_isdst = -1;
-            t = mktime(&tmp);
+            z++;
+            t = UtcFromLocal(z * 86400);
         }
 
         time_t stop = view_end + 86400 * 10;
@@ -482,8 +418,7 @@ void HandlePanningAndZooming(void)
 
             if (x >= left - 100 && x <= right + 100)
             {
-                struct tm *dtm = SafeLocalTime(&t);
-                int day = dtm->tm_mday;
+                CivilFromDays(z, &year, &mon, &day);
 
                 bool is_month_start  = (day == 1);
                 bool is_week_divider = (day == 8 || day == 15 || day == 22 || day == 29);
@@ -505,9 +440,8 @@ void HandlePanningAndZooming(void)
                 }
             }
 
-            tmp.tm_mday++;
-            tmp.tm_isdst = -1;
-            t = mktime(&tmp);
+            z++;
+            t = UtcFromLocal(z * 86400);
         }
     }
 }
@@ -544,47 +478,177 @@ void DrawCursorIndicator(void)
     DrawCircle(x, timeline_y_center, 2.0f, (Color){180, 240, 255, 255});
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Event layer batching – bars and end caps are textured quads from one small
+// atlas (two cap rings, the selection halo and a solid texel for the bars), so
+// the whole layer goes through rlgl's batch as a handful of draw calls instead
+// of a DrawLineEx plus four 32-segment DrawRings per event.
+// ─────────────────────────────────────────────────────────────────────────────
+#define CAP_CELL 16
+#define EVENT_ROW_SPACING 10.0f
+#define EVENT_THICKNESS   3.5f
+
+enum { CAP_OUTER, CAP_INNER, CAP_HALO, CAP_SOLID, CAP_CELLS };
+
+static Texture2D cap_atlas = {0};
+
+// Coverage of the ring inner..outer over one pixel, 4x4 supersampled
+static unsigned char RingCoverage(int px, int py, float inner, float outer)
+{
+    int hits = 0;
+    for (int sy = 0; sy < 4; sy++)
+        for (int sx = 0; sx < 4; sx++) {
+            float dx = px + (sx + 0.5f) / 4.0f - CAP_CELL * 0.5f;
+            float dy = py + (sy + 0.5f) / 4.0f - CAP_CELL * 0.5f;
+            float r = sqrtf(dx*dx + dy*dy);
+            if (r >= inner && r <= outer) hits++;
+        }
+    return (unsigned char)(hits * 255 / 16);
+}
+
+static void BuildCapAtlas(void)
+{
+    Image img = GenImageColor(CAP_CELL * CAP_CELLS, CAP_CELL, BLANK);
+    Color *px = img.data;
+    const float radii[CAP_CELLS][2] = { {4.6f, 5.4f}, {2.6f, 3.4f}, {5.8f, 6.8f}, {0.0f, 0.0f} };
+
+    for (int cell = 0; cell < CAP_CELLS; cell++)
+        for (int y = 0; y < CAP_CELL; y++)
+            for (int x = 0; x < CAP_CELL; x++) {
+                unsigned char a = (cell == CAP_SOLID) ? 255 : RingCoverage(x, y, radii[cell][0], radii[cell][1]);
+                px[y * img.width + cell * CAP_CELL + x] = (Color){255, 255, 255, a};
+            }
+
+    cap_atlas = LoadTextureFromImage(img);
+    SetTextureFilter(cap_atlas, TEXTURE_FILTER_BILINEAR);
+    UnloadImage(img);
+}
+
+static void EventBatchBegin(void)
+{
+    if (cap_atlas.id == 0) BuildCapAtlas();
+    rlSetTexture(cap_atlas.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+}
+
+static void EventBatchEnd(void)
+{
+    rlEnd();
+    rlSetTexture(0);
+}
+
+static void EventBatchQuad(float x0, float y0, float x1, float y1, int cell, Color c)
+{
+    float u0 = (float)(cell * CAP_CELL) / (CAP_CELL * CAP_CELLS);
+    float u1 = (float)((cell + 1) * CAP_CELL) / (CAP_CELL * CAP_CELLS);
+    float v0 = 0.0f, v1 = 1.0f;
+    if (cell == CAP_SOLID) {
+        // Sample the middle of the solid cell so bilinear filtering never reaches its edge
+        u0 = u1 = (cell * CAP_CELL + CAP_CELL * 0.5f) / (CAP_CELL * CAP_CELLS);
+        v0 = v1 = 0.5f;
+    }
+
+    rlCheckRenderBatchLimit(4);
+    rlColor4ub(c.r, c.g, c.b, c.a);
+    rlTexCoord2f(u0, v0); rlVertex2f(x0, y0);
+    rlTexCoord2f(u0, v1); rlVertex2f(x0, y1);
+    rlTexCoord2f(u1, v1); rlVertex2f(x1, y1);
+    rlTexCoord2f(u1, v0); rlVertex2f(x1, y0);
+}
+
+static void EventBatchCap(float x, float y, int cell, Color c)
+{
+    const float h = CAP_CELL * 0.5f;
+    EventBatchQuad(x - h, y - h, x + h, y + h, cell, c);
+}
+
+void UnloadEventBatch(void)
+{
+    if (cap_atlas.id) UnloadTexture(cap_atlas);
+    cap_atlas = (Texture2D){0};
+}
+
+// Tracks [*first, *last] reach onto the canvas; while exporting, only the ones
+// that reach into the band of rows being rendered
+static void CanvasTracks(float row_spacing, int *first, int *last)
+{
+    float top = export_canvas.active ? export_canvas.top : 0.0f;
+    float bottom = export_canvas.active ? export_canvas.bottom : CanvasHeight();
+    *first = (int)floorf((top - CAP_CELL - events_start_y) / row_spacing);
+    *last  = (int)ceilf((bottom + CAP_CELL - events_start_y) / row_spacing);
+    if (*first < 0) *first = 0;
+}
+
+// One strip per (track, bucket) holding short events, its opacity the share of
+// the bucket they cover. Only header cells seen on screen lead to row lookups.
+static void DrawEventHeat(int level, float row_spacing, float thickness)
+{
+    const int shift = LOD_BASE_SHIFT + level;
+    const double bucket_px = LodBucketSecs(level) / secs_per_pixel;
+    const time_t view_end = tracker.view_start + (time_t)(CanvasWidth() * secs_per_pixel);
+    int first, last;
+    CanvasTracks(row_spacing, &first, &last);
+    if (last < first) return;
+
+    for (int64_t b = tracker.view_start >> shift; b <= (view_end >> shift); b++) {
+        const LodCell *h = LodFind(LodKey(level, LOD_HEADER, b));
+        if (!h) continue;
+        float x0 = (float)(difftime((time_t)(b * LodBucketSecs(level)), tracker.view_start) / secs_per_pixel);
+        float x1 = x0 + (float)bucket_px;
+        int tracks = (int)h->count <= last ? (int)h->count : last + 1;
+
+        for (int t = first; t < tracks; t++) {
+            const LodCell *c = LodFind(LodKey(level, t, b));
+            if (!c || (c->count == 0 && c->covered == 0)) continue;
+            float share = (float)c->covered / (float)LodBucketSecs(level);
+            float y = events_start_y + t * row_spacing;
+            EventBatchQuad(fmaxf(x0, 0.0f), y - thickness * 0.5f, x1, y + thickness * 0.5f, CAP_SOLID,
+                           Fade((Color){240,40,40,255}, 0.3f + 0.7f * fminf(share, 1.0f)));
+        }
+    }
+}
+
 void DrawEvents(void)
 {
     Vector2 mouse = GetMousePosition();
-    const float row_spacing = 10.0f;
-    const float line_thickness = 3.5f;
-    const int   max_tracks = 50;
+    const float row_spacing = EVENT_ROW_SPACING;
+    const float line_thickness = EVENT_THICKNESS;
 
     secs_per_pixel = (365.25 * 86400.0) / tracker.pixels_per_year;
 
     clicked_on_event_this_frame = false;
     g_show_tooltip = false;
+    bool over_ui = export_canvas.active || SearchOwnsMouse() || LayerChipsOwnMouse();   // both sit on top of the events
+
+    // Tracks are kept up to date by the index as events change; nothing to stack here.
+    // Draw only what overlaps the screen, padded by the 2 px minimum bar and the end caps.
+    // Zoomed out, events shorter than a LOD bucket come from the heat strips instead.
+    time_t pad      = (time_t)(8.0 * secs_per_pixel) + 1;
+    time_t view_end = tracker.view_start + (time_t)(CanvasWidth() * secs_per_pixel);
+    int level = LodLevelFor(secs_per_pixel);
+    time_t min_len = level >= 0 ? LodBucketSecs(level) : 0;
+    int visible = IndexQuery(tracker.view_start - pad, view_end + pad, min_len);
+    const float screen_w = CanvasWidth();
+    int first_track, last_track;
+    CanvasTracks(row_spacing, &first_track, &last_track);
+
+    // The selected/dragged event stays a bar of its own so it can still be grabbed
+    for (int k = 0; k < 2 && level >= 0; k++) {
+        int i = k ? dragging : selected;
+        if (i < 0 || i >= tracker.count || tracker.track[i] < 0 || (k && dragging == selected)) continue;
+        if (tracker.end[i] - tracker.start[i] < min_len &&
+            tracker.start[i] <= view_end + pad && tracker.end[i] >= tracker.view_start - pad)
+            ev_index.hits[visible++] = i;
+    }
 
-    // Sort events by start time
-    int order[MAX_ENTRIES];
-    for (int i = 0; i < tracker.count; i++) order[i] = i;
-    for (int i = 0; i < tracker.count - 1; i++)
-        for (int j = i + 1; j < tracker.count; j++)
-            if (tracker.entries[order[i]].start > tracker.entries[order[j]].start)
-                { int tmp = order[i]; order[i] = order[j]; order[j] = tmp; }
-
-    // Reset track availability
-    for (int t = 0; t < max_tracks; t++) track_free_until[t] = 0;
-
-    // Assign vertical tracks (stacking)
-    for (int k = 0; k < tracker.count; k++) {
-        int i = order[k];
-        Entry *e = &tracker.entries[i];
-        int track = 0;
-        while (track < max_tracks && e->start < track_free_until[track]) track++;
-        if (track >= max_tracks) track = max_tracks - 1;
-        track_free_until[track] = e->end;
-        g_track_of_event[i] = track;
-    }
-
-    // Draw every event
-    for (int i = 0; i < tracker.count; i++) {
-        Entry *e = &tracker.entries[i];
-
-        double secs_from_view = difftime(e->start, tracker.view_start);
+    EventBatchBegin();
+    if (level >= 0) DrawEventHeat(level, row_spacing, line_thickness);
+    for (int h = 0; h < visible; h++) {
+        int i = ev_index.hits[h];
+        double secs_from_view = difftime(tracker.start[i], tracker.view_start);
         float x_start = (float)(secs_from_view * tracker.pixels_per_year / (365.25 * 86400.0));
-        float duration_px = e->duration_years * tracker.pixels_per_year;
+        float duration_px = DurationYears(i) * tracker.pixels_per_year;
         if (duration_px < 2.0f) duration_px = 2.0f;
 
         float draw_x1 = fmaxf(x_start, 0.0f);
@@ -592,11 +656,13 @@ void DrawEvents(void)
         float draw_len = draw_x2 - draw_x1;
         if (draw_len <= 0.0f) continue;
 
-        float y = events_start_y + g_track_of_event[i] * row_spacing;
+        // Stacked below the window, or outside the band an export is rendering
+        if (tracker.track[i] < first_track || tracker.track[i] > last_track) continue;
+        float y = events_start_y + tracker.track[i] * row_spacing;
 
         // Hover detection
         Rectangle hit = { draw_x1, y - 7, draw_len, 16 };
-        bool hovered = CheckCollisionPointRec(mouse, hit);
+        bool hovered = !over_ui && CheckCollisionPointRec(mouse, hit);
 
         // Selection & dragging
         if (hovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
@@ -604,95 +670,641 @@ void DrawEvents(void)
         }
         if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && hovered && dragging == -1) {
             selected = i;
-            dragging = i;
+            dragging = tracker.layer[i] ? -1 : i;   // overlays can be selected but not moved
+            if (dragging >= 0) HistoryEditing(i);
             float rel_x = mouse.x - draw_x1;
             drag_mode = (rel_x < EDGE_GRAB_PIXELS) ? 1 :
                         (rel_x > draw_len - EDGE_GRAB_PIXELS) ? 2 : 0;
             time_t cursor_time = tracker.view_start + (time_t)(mouse.x * secs_per_pixel);
-            if (drag_mode == 1)      drag_offset = e->start - cursor_time;
-            else if (drag_mode == 2) drag_offset = e->end   - cursor_time;
-            else { drag_offset = e->start - cursor_time; original_duration = e->end - e->start; }
+            if (drag_mode == 1)      drag_offset = tracker.start[i] - cursor_time;
+            else if (drag_mode == 2) drag_offset = tracker.end[i]   - cursor_time;
+            else { drag_offset = tracker.start[i] - cursor_time; original_duration = tracker.end[i] - tracker.start[i]; }
         }
 
         // Colors
         bool is_selected = (selected == i);
         bool is_dragging = (dragging == i);
-        Color col = is_dragging ? RED :
-                    is_selected ? (Color){255,70,70,255} :
-                    hovered     ? (Color){255,130,130,255} : (Color){240,40,40,255};
+        Color col;
+        if (tracker.layer[i]) {
+            EventColor c = tracker.color[i];
+            col = (Color){c.r, c.g, c.b, c.a};
+            if (is_selected || hovered) col = ColorBrightness(col, is_selected ? 0.35f : 0.2f);
+        } else {
+            col = is_dragging ? RED :
+                  is_selected ? (Color){255,70,70,255} :
+                  hovered     ? (Color){255,130,130,255} : (Color){240,40,40,255};
+        }
 
-        // Draw the bar
-        DrawLineEx((Vector2){draw_x1, y}, (Vector2){draw_x1 + draw_len, y}, line_thickness, col);
+        // Draw the bar (clipped to the window so far-off ends stay within float precision)
+        float bar_x2 = fminf(draw_x1 + draw_len, screen_w + CAP_CELL);
+        EventBatchQuad(draw_x1, y - line_thickness * 0.5f, bar_x2, y + line_thickness * 0.5f, CAP_SOLID, col);
 
         // End caps
-        DrawRing((Vector2){x_start, y}, 4.6f, 5.4f, 0, 360, 32, Fade(WHITE, 0.75f));
-        DrawRing((Vector2){x_start, y}, 2.6f, 3.4f, 0, 360, 32, col);
-        DrawRing((Vector2){draw_x2, y}, 4.6f, 5.4f, 0, 360, 32, Fade(WHITE, 0.75f));
-        DrawRing((Vector2){draw_x2, y}, 2.6f, 3.4f, 0, 360, 32, col);
+        EventBatchCap(x_start, y, CAP_OUTER, Fade(WHITE, 0.75f));
+        EventBatchCap(x_start, y, CAP_INNER, col);
+        EventBatchCap(draw_x2, y, CAP_OUTER, Fade(WHITE, 0.75f));
+        EventBatchCap(draw_x2, y, CAP_INNER, col);
 
         if (is_selected || is_dragging) {
-            DrawRing((Vector2){x_start, y}, 5.8f, 6.8f, 0, 360, 32, Fade(YELLOW, 0.45f));
-            DrawRing((Vector2){draw_x2, y}, 5.8f, 6.8f, 0, 360, 32, Fade(YELLOW, 0.45f));
+            EventBatchCap(x_start, y, CAP_HALO, Fade(YELLOW, 0.45f));
+            EventBatchCap(draw_x2, y, CAP_HALO, Fade(YELLOW, 0.45f));
         }
                                 
         // TOOLTIP
-        if (hovered && e->description[0]) {
-            strncpy(g_tooltip_text, e->description, 511);
-            g_tooltip_text[511] = '\0';
+        if (hovered && EventDesc(i)[0]) {
+            g_tooltip_text = EventDesc(i);
             g_tooltip_x = mouse.x;
             g_tooltip_y = mouse.y;
             g_show_tooltip = true;
         }
     }
+    EventBatchEnd();
 
     // Click empty space → deselect
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !clicked_on_event_this_frame && selected >= 0) {
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !clicked_on_event_this_frame && !over_ui && selected >= 0) {
         selected = -1;
         dragging = -1;
         SyncInputsToSelected();
     }
 }
 
-void DrawGlobalTooltip(void)
+// ─────────────────────────────────────────────────────────────────────────────
+// Export – F6 writes the visible range as a poster EXPORT_SCALE times the width
+// of the window; "timeTracker export" (see Command line) any range at any width.
+// Either way the image is as tall as the tracks in the range need. The PNG is
+// DrawTimelineGrid + DrawEvents rendered tile by tile into a render texture;
+// each band of rows goes to the PNG writer once its tiles are in, so memory
+// stays at one band however big the image. A tile's IndexQuery only spans its
+// own width, and only the tracks reaching into its band get drawn. The SVG
+// holds the same bars as shapes, for the events the interval index finds in
+// the range.
+// ─────────────────────────────────────────────────────────────────────────────
+#define EXPORT_SCALE 8
+#define EXPORT_TILE  2048   // tile width; a tile is one band tall
+#define EXPORT_BAND  128    // rows rendered and encoded at a time
+
+static const Color EXPORT_BACKGROUND = {12, 12, 28, 255};
+
+// Renders from `from` at tracker.pixels_per_year; the caller restores the view
+static bool ExportPng(const char *file, time_t from, int width, int height)
 {
-    if (!g_show_tooltip) return;
+    double secs_per_px = (365.25 * 86400.0) / tracker.pixels_per_year;
+    RenderTexture2D tile = LoadRenderTexture(EXPORT_TILE, EXPORT_BAND);
+    unsigned char *band = malloc((size_t)width * EXPORT_BAND * 4);
+    PngWriter *png = tile.id && band ? PngBegin(file, width, height) : NULL;
+    bool ok = png != NULL;
+
+    export_canvas.active = true;
+    export_canvas.height = height;
+    for (int y0 = 0; ok && y0 < height; y0 += EXPORT_BAND) {
+        int rows = height - y0 < EXPORT_BAND ? height - y0 : EXPORT_BAND;
+        export_canvas.top = y0;
+        export_canvas.bottom = y0 + rows;
+        for (int x0 = 0; ok && x0 < width; x0 += EXPORT_TILE) {
+            int cols = width - x0 < EXPORT_TILE ? width - x0 : EXPORT_TILE;
+            export_canvas.width = cols;
+            tracker.view_start = from + (time_t)llround(x0 * secs_per_px);
+            BeginTextureMode(tile);
+                ClearBackground(EXPORT_BACKGROUND);
+                rlPushMatrix();
+                rlTranslatef(0.0f, -(float)y0, 0.0f);
+                DrawTimelineGrid();
+                DrawEvents();
+                rlPopMatrix();
+            EndTextureMode();
+
+            Image img = LoadImageFromTexture(tile.texture);
+            ok = img.data != NULL;
+            if (!ok) break;
+            ImageFlipVertical(&img);   // render textures read back bottom-up
+            for (int r = 0; r < rows; r++)
+                memcpy(band + ((size_t)r * width + x0) * 4,
+                       (unsigned char *)img.data + (size_t)r * EXPORT_TILE * 4, (size_t)cols * 4);
+            UnloadImage(img);
+        }
+        ok = ok && PngWriteRows(png, band, rows);
+    }
+    export_canvas.active = false;
 
-    const float fontSize = 19.0f;
-    const float spacing  = 1.2f;
-    const float maxWidth = 640.0f;
-    const float pad      = 24.0f;
-    const float lineH    = fontSize + 10.0f;
+    ok = PngEnd(png) && ok;
+    if (!ok) remove(file);
+    free(band);
+    if (tile.id) UnloadRenderTexture(tile);
+    return ok;
+}
 
-    // ── Measure total height ──
-    float totalH = pad * 2.0f;
-    float lineW  = 0.0f;
-    const char* p = g_tooltip_text;
+static void WriteXmlText(FILE *f, const char *s)
+{
+    for (; *s; s++) {
+        if      (*s == '&') fputs("&amp;", f);
+        else if (*s == '<') fputs("&lt;", f);
+        else if (*s == '>') fputs("&gt;", f);
+        else if (*s == '"') fputs("&quot;", f);
+        else if ((unsigned char)*s >= 0x20 || *s == '\n' || *s == '\t') fputc(*s, f);
+    }
+}
 
-    while (*p) {
-        if (*p == '\n') {
-            totalH += lineH;
-            lineW = 0.0f;
-            p++;
-            continue;
+// Same frame as ExportPng: baseline, year and month ticks, then one bar with
+// its two caps per event, titled with the event's name
+static bool ExportSvg(const char *file, time_t from, int width, int height)
+{
+    FILE *f = fopen(file, "w");
+    if (!f) return false;
+    double secs_per_px = (365.25 * 86400.0) / tracker.pixels_per_year;
+    time_t to = from + (time_t)(width * secs_per_px);
+    const float baseline_y = 260.0f;
+
+    fprintf(f, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n",
+            width, height, width, height);
+    fprintf(f, "<rect width=\"100%%\" height=\"100%%\" fill=\"#0c0c1c\"/>\n");
+    fprintf(f, "<line x1=\"0\" y1=\"%.0f\" x2=\"%d\" y2=\"%.0f\" stroke=\"#5a5a8c\" stroke-width=\"3\"/>\n",
+            baseline_y, width, baseline_y);
+
+    int year, mon, day, end_year;
+    LocalCivil(from, &year, &mon, &day);
+    LocalCivil(to, &end_year, &mon, &day);
+    if (tracker.pixels_per_year > 30.0f) {
+        fputs("<g fill=\"white\" stroke=\"white\" font-family=\"sans-serif\" font-size=\"36\">\n", f);
+        for (int y = year; y <= end_year; y++) {
+            float x = (float)(difftime(LocalFromCivil(y, 1, 1, 0, 0), from) / secs_per_px);
+            if (x < 0.0f || x > width) continue;
+            fprintf(f, "<line x1=\"%.1f\" y1=\"%.0f\" x2=\"%.1f\" y2=\"%.0f\" stroke-width=\"4\"/>"
+                       "<text transform=\"translate(%.1f %.0f) rotate(90)\" stroke=\"none\">%d</text>\n",
+                    x, baseline_y - 28, x, baseline_y + 28, x + 16, baseline_y - 200, y);
         }
+        fputs("</g>\n", f);
+    }
+    if (tracker.pixels_per_year > 250.0f) {
+        fputs("<g fill=\"white\" fill-opacity=\"0.9\" stroke=\"white\" stroke-opacity=\"0.65\" font-family=\"sans-serif\" font-size=\"17\">\n", f);
+        int y, m;
+        LocalCivil(from, &y, &m, &day);
+        for (time_t t = LocalFromCivil(y, m, 1, 0, 0); t <= to; t = LocalFromCivil(y, m, 1, 0, 0)) {
+            float x = (float)(difftime(t, from) / secs_per_px);
+            if (x >= 0.0f)
+                fprintf(f, "<line x1=\"%.1f\" y1=\"%.0f\" x2=\"%.1f\" y2=\"%.0f\" stroke-width=\"1.9\"/>"
+                           "<text transform=\"translate(%.1f %.0f) rotate(90)\" stroke=\"none\">%s</text>\n",
+                        x, baseline_y - 15, x, baseline_y + 14, x + 10, baseline_y - 65, MONTH_ABBR[m - 1]);
+            if (++m > 12) { m = 1; y++; }
+        }
+        fputs("</g>\n", f);
+    }
 
-        const char* start = p;
-        while (*p && *p != ' ' && *p != '\n') p++;
-        int len = (int)(p - start);
-        if (len == 0) { p++; continue; }
+    // DrawEvents' padding and 2 px minimum, but no LOD: a vector file can take every bar
+    time_t pad = (time_t)(8.0 * secs_per_px) + 1;
+    int n = IndexQuery(from - pad, to + pad, 0);
+    fputs("<g stroke=\"white\" stroke-opacity=\"0.75\" stroke-width=\"0.8\">\n", f);
+    for (int h = 0; h < n; h++) {
+        int i = ev_index.hits[h];
+        float x1 = (float)(difftime(tracker.start[i], from) / secs_per_px);
+        float x2 = x1 + fmaxf((float)(DurationYears(i) * tracker.pixels_per_year), 2.0f);
+        float y = events_start_y + tracker.track[i] * EVENT_ROW_SPACING;
+        if (y - CAP_CELL > height) continue;
+        float bar_x1 = fmaxf(x1, -CAP_CELL), bar_x2 = fminf(x2, width + CAP_CELL);
+        EventColor c = tracker.layer[i] ? tracker.color[i] : (EventColor){240, 40, 40, 255};
+
+        fprintf(f, "<g fill=\"#%02x%02x%02x\"><title>", c.r, c.g, c.b);
+        WriteXmlText(f, EventName(i));
+        fprintf(f, "</title><rect x=\"%.1f\" y=\"%.2f\" width=\"%.1f\" height=\"%.1f\" stroke=\"none\"/>"
+                   "<circle cx=\"%.1f\" cy=\"%.0f\" r=\"3\"/><circle cx=\"%.1f\" cy=\"%.0f\" r=\"3\"/></g>\n",
+                bar_x1, y - EVENT_THICKNESS * 0.5f, bar_x2 - bar_x1, EVENT_THICKNESS, x1, y, x2, y);
+    }
+    fputs("</g>\n</svg>\n", f);
+
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) ok = false;
+    if (!ok) remove(file);
+    return ok;
+}
 
-        float wordW = MeasureTextEx(font, TextFormat("%.*s", len, start), fontSize, spacing).x;
-        float spaceW = (lineW > 0.0f) ? MeasureTextEx(font, " ", fontSize, spacing).x : 0.0f;
+// Tall enough for the deepest track anything in [from, to] sits on
+static int ExportHeight(time_t from, time_t to, int min_height)
+{
+    int tracks = 0, n = IndexQuery(from, to, 0);
+    for (int h = 0; h < n; h++)
+        if (tracker.track[ev_index.hits[h]] + 1 > tracks) tracks = tracker.track[ev_index.hits[h]] + 1;
+    int height = (int)(events_start_y + tracks * EVENT_ROW_SPACING + 40.0f);
+    return height < min_height ? min_height : height;
+}
 
-        if (lineW + spaceW + wordW > maxWidth - pad*2 && lineW > 0.0f) {
-            totalH += lineH;
-            lineW = 0.0f;
+// Writes `width` px from `from` at pixels_per_year to whichever of png and svg
+// isn't NULL; the view and selection are put back afterwards
+static bool ExportRange(const char *png, const char *svg, time_t from, int width, int height, double pixels_per_year)
+{
+    time_t view_start = tracker.view_start;
+    double view_pixels_per_year = tracker.pixels_per_year;
+    int keep_selected = selected;
+    selected = -1;   // no highlight on the poster
+    tracker.pixels_per_year = pixels_per_year;
+
+    bool ok = true;
+    if (png && !ExportPng(png, from, width, height)) {
+        TraceLog(LOG_WARNING, "Export: couldn't write %s", png);
+        ok = false;
+    }
+    if (svg && !ExportSvg(svg, from, width, height)) {
+        TraceLog(LOG_WARNING, "Export: couldn't write %s", svg);
+        ok = false;
+    }
+    tracker.view_start = view_start;
+    tracker.pixels_per_year = view_pixels_per_year;
+    selected = keep_selected;
+    return ok;
+}
+
+// F6: timeline_export.png and .svg next to timetracker.json
+void ExportTimeline(void)
+{
+    double secs_per_px = (365.25 * 86400.0) / tracker.pixels_per_year;
+    time_t from = tracker.view_start, to = from + (time_t)(GetScreenWidth() * secs_per_px);
+    int width = GetScreenWidth() * EXPORT_SCALE;
+    int height = ExportHeight(from, to, GetScreenHeight());
+
+    double t0 = GetTime();
+    if (ExportRange("timeline_export.png", "timeline_export.svg", from, width, height, tracker.pixels_per_year * EXPORT_SCALE))
+        TraceLog(LOG_INFO, "Export %dx%d in %.1f s: timeline_export.png, timeline_export.svg", width, height, GetTime() - t0);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Glyph cache – the font starts with ASCII and rasterizes other codepoints the
+// first time something measures them (loaded names, typed characters, pastes).
+// New glyphs are shelf-packed into one atlas image that doubles in height when
+// full and is re-uploaded once per frame that added glyphs.
+//
+// glyph_advance answers "how wide is this codepoint" for the BMP with one load,
+// instead of raylib's linear scan over every glyph; MeasureCodepoints
+// reproduces MeasureTextEx's math on top of it.
+// ─────────────────────────────────────────────────────────────────────────────
+#define GLYPH_TABLE_SIZE  0x10000
+#define GLYPH_BASE_SIZE   32
+#define GLYPH_PADDING     4
+#define GLYPH_ATLAS_W     1024
+#define GLYPH_ATLAS_MAX_H 8192
+#define GLYPH_UNKNOWN     (-1.0f)   // not rasterized yet
+#define GLYPH_QUEUED      (-2.0f)   // waiting for GlyphCacheFlush
+
+static float *glyph_advance = NULL;   // unscaled, indexed by codepoint
+static float glyph_fallback = 0.0f;   // what an unknown codepoint measures (and draws) as
+
+typedef struct {
+    unsigned char *ttf;   // font file, kept to rasterize more glyphs later
+    int ttf_size;
+    Image atlas;          // GRAY_ALPHA, mirrors font.texture
+    int pack_x, pack_y, shelf_h;
+    bool texture_stale, texture_resized;
+    int *pending;
+    int pending_count, pending_cap;
+} GlyphCache;
+
+static GlyphCache glyph_cache = {0};
+
+static float GlyphAdvanceAt(int index)
+{
+    if (index < 0 || index >= font.glyphCount) return 0.0f;
+    if (font.glyphs[index].advanceX > 0) return (float)font.glyphs[index].advanceX;
+    return font.recs[index].width + font.glyphs[index].offsetX;
+}
+
+// Call after (re)loading the font
+void BuildGlyphAdvances(void)
+{
+    if (!glyph_advance) glyph_advance = malloc(GLYPH_TABLE_SIZE * sizeof(float));
+    if (!glyph_advance) return;
+
+    // Missing codepoints draw as the fallback glyph, so they measure as it too;
+    // with a font file to rasterize from they are only missing for now
+    glyph_fallback = GlyphAdvanceAt(GetGlyphIndex(font, '?'));
+    float missing = glyph_cache.ttf ? GLYPH_UNKNOWN : glyph_fallback;
+    for (int cp = 0; cp < GLYPH_TABLE_SIZE; cp++) glyph_advance[cp] = missing;
+    for (int k = 0; k < font.glyphCount; k++) {
+        int cp = font.glyphs[k].value;
+        if (cp >= 0 && cp < GLYPH_TABLE_SIZE) glyph_advance[cp] = GlyphAdvanceAt(k);
+    }
+}
+
+// BMP codepoints are deduplicated by their GLYPH_QUEUED mark, the rest here
+static void GlyphQueue(int codepoint)
+{
+    if (codepoint >= GLYPH_TABLE_SIZE)
+        for (int k = 0; k < glyph_cache.pending_count; k++) if (glyph_cache.pending[k] == codepoint) return;
+    if (glyph_cache.pending_count == glyph_cache.pending_cap) {
+        int cap = glyph_cache.pending_cap ? glyph_cache.pending_cap * 2 : 64;
+        if (!GrowColumn(&glyph_cache.pending, sizeof(int), cap)) return;
+        glyph_cache.pending_cap = cap;
+    }
+    glyph_cache.pending[glyph_cache.pending_count++] = codepoint;
+}
+
+static float GlyphAdvance(int codepoint)
+{
+    if (glyph_advance && codepoint >= 0 && codepoint < GLYPH_TABLE_SIZE) {
+        float adv = glyph_advance[codepoint];
+        if (adv >= 0.0f) return adv;
+        if (adv == GLYPH_UNKNOWN) { glyph_advance[codepoint] = GLYPH_QUEUED; GlyphQueue(codepoint); }
+        return glyph_fallback;
+    }
+    int index = GetGlyphIndex(font, codepoint);
+    if (glyph_cache.ttf && codepoint > 0 && (index >= font.glyphCount || font.glyphs[index].value != codepoint))
+        GlyphQueue(codepoint);
+    return GlyphAdvanceAt(index);
+}
+
+// Makes sure every codepoint of text gets rasterized on the next flush
+void GlyphRequireText(const char *text)
+{
+    while (*text) {
+        int size = 1;
+        GlyphAdvance(GetCodepointNext(text, &size));
+        text += size > 0 ? size : 1;
+    }
+}
+
+// Finds room for a w x h glyph (plus padding), growing the atlas if needed
+static bool GlyphPack(int w, int h, int *x, int *y)
+{
+    GlyphCache *gc = &glyph_cache;
+    int pw = w + 2 * GLYPH_PADDING, ph = h + 2 * GLYPH_PADDING;
+    if (pw > gc->atlas.width) return false;
+    if (gc->pack_x + pw > gc->atlas.width) {
+        gc->pack_x = 0;
+        gc->pack_y += gc->shelf_h;
+        gc->shelf_h = 0;
+    }
+    while (gc->pack_y + ph > gc->atlas.height) {
+        int new_h = gc->atlas.height * 2;
+        if (new_h > GLYPH_ATLAS_MAX_H) return false;
+        unsigned char *data = realloc(gc->atlas.data, (size_t)gc->atlas.width * new_h * 2);
+        if (!data) return false;
+        memset(data + (size_t)gc->atlas.width * gc->atlas.height * 2, 0,
+               (size_t)gc->atlas.width * (new_h - gc->atlas.height) * 2);
+        gc->atlas.data = data;
+        gc->atlas.height = new_h;
+        gc->texture_resized = true;
+    }
+    *x = gc->pack_x + GLYPH_PADDING;
+    *y = gc->pack_y + GLYPH_PADDING;
+    gc->pack_x += pw;
+    if (ph > gc->shelf_h) gc->shelf_h = ph;
+    return true;
+}
+
+// Rasterizes everything queued since the last call and refreshes the texture.
+// Call once per frame before drawing; returns true if glyphs were added.
+bool GlyphCacheFlush(void)
+{
+    GlyphCache *gc = &glyph_cache;
+    if (!gc->ttf || gc->pending_count == 0) return false;
+
+    int n = gc->pending_count;
+    gc->pending_count = 0;
+    GlyphInfo *glyphs = LoadFontData(gc->ttf, gc->ttf_size, GLYPH_BASE_SIZE, gc->pending, n, FONT_DEFAULT);
+    GlyphInfo *all = glyphs ? realloc(font.glyphs, (font.glyphCount + n) * sizeof(GlyphInfo)) : NULL;
+    if (all) font.glyphs = all;
+    Rectangle *recs = all ? realloc(font.recs, (font.glyphCount + n) * sizeof(Rectangle)) : NULL;
+    if (recs) font.recs = recs;
+
+    for (int k = 0; k < n; k++) {
+        GlyphInfo g = glyphs ? glyphs[k] : (GlyphInfo){ .value = gc->pending[k] };
+        int x = 0, y = 0;
+        bool placed = recs && GlyphPack(g.image.width, g.image.height, &x, &y);
+        if (placed) {
+            const unsigned char *src = g.image.data;
+            unsigned char *dst = gc->atlas.data;
+            for (int row = 0; row < g.image.height && src; row++)
+                for (int col = 0; col < g.image.width; col++) {
+                    size_t o = ((size_t)(y + row) * gc->atlas.width + x + col) * 2;
+                    dst[o] = 255;
+                    dst[o + 1] = src[row * g.image.width + col];
+                }
+            font.recs[font.glyphCount] = (Rectangle){ (float)x, (float)y, (float)g.image.width, (float)g.image.height };
+            font.glyphs[font.glyphCount] = g;
+            font.glyphs[font.glyphCount].image = (Image){0};
+            font.glyphCount++;
+            gc->texture_stale = true;
+        }
+        // Whatever happened, stop asking for this codepoint
+        if (g.value >= 0 && g.value < GLYPH_TABLE_SIZE && glyph_advance)
+            glyph_advance[g.value] = placed ? GlyphAdvanceAt(font.glyphCount - 1) : glyph_fallback;
+        if (glyphs) UnloadImage(g.image);
+    }
+    if (glyphs) RL_FREE(glyphs);
+
+    if (gc->texture_stale) {
+        if (gc->texture_resized || font.texture.id == 0) {
+            if (font.texture.id != 0) UnloadTexture(font.texture);
+            font.texture = LoadTextureFromImage(gc->atlas);
+            SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
+        } else {
+            UpdateTexture(font.texture, gc->atlas.data);
+        }
+        gc->texture_stale = gc->texture_resized = false;
+    }
+
+    // Widths measured with the fallback glyph are stale now
+    text_generation++;
+    TextInputReflow(&name_input);
+    TextInputReflow(&start_input);
+    TextInputReflow(&end_input);
+    TextInputReflow(&desc_input);
+    TextInputReflow(&search_input);
+    return true;
+}
+
+void UnloadGlyphCache(void);
+
+// Opens a TTF/OTF for lazy rasterization; `font` gets ASCII right away
+bool LoadGlyphCache(const char *path)
+{
+    GlyphCache *gc = &glyph_cache;
+    gc->ttf = LoadFileData(path, &gc->ttf_size);
+    if (!gc->ttf) return false;
+
+    gc->atlas = (Image){ calloc((size_t)GLYPH_ATLAS_W * 256, 2), GLYPH_ATLAS_W, 256, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+    if (!gc->atlas.data) { UnloadFileData(gc->ttf); gc->ttf = NULL; return false; }
+    font = (Font){ .baseSize = GLYPH_BASE_SIZE, .glyphPadding = GLYPH_PADDING };
+
+    for (int cp = 32; cp < 127; cp++) GlyphQueue(cp);
+    GlyphCacheFlush();
+    BuildGlyphAdvances();
+    if (font.texture.id == 0 || font.glyphCount == 0) { UnloadGlyphCache(); return false; }
+    return true;
+}
+
+void UnloadGlyphCache(void)
+{
+    GlyphCache *gc = &glyph_cache;
+    if (gc->ttf) UnloadFileData(gc->ttf);
+    free(gc->atlas.data);
+    free(gc->pending);
+    *gc = (GlyphCache){0};
+}
+
+// The first of a few known fonts that loads, else raylib's default
+void LoadUiFont(void)
+{
+    const char* preferred_paths[] = {
+        "resources/NotoSans-Regular.ttf",                 // ← your bundled copy
+        "/usr/share/fonts/noto/NotoSans-Regular.ttf",
+        "/usr/share/fonts/TTF/DejaVuSans.ttf",
+        NULL
+    };
+
+    font = (Font){0};
+
+    for (int i = 0; preferred_paths[i]; i++) {
+        if (FileExists(preferred_paths[i])) {
+            // Only ASCII up front, everything else gets rasterized when first seen
+            if (LoadGlyphCache(preferred_paths[i])) {
+                TraceLog(LOG_INFO, "Loaded font: %s → FULL UNICODE SUPPORT (on demand)", preferred_paths[i]);
+                break;
+            }
         }
-        lineW += spaceW + wordW;
+    }
+
+    // Absolute last resort
+    if (font.texture.id == 0) {
+        font = GetFontDefault();
+        TraceLog(LOG_WARNING, "Using raylib default font – limited Unicode");
+    }
+    BuildGlyphAdvances();
+}
+
+// Same width MeasureTextEx gives for these codepoints on one line
+static float MeasureCodepoints(const int *cps, int count, float size, float spacing)
+{
+    if (count <= 0 || font.baseSize <= 0) return 0.0f;
+    float w = 0.0f;
+    for (int k = 0; k < count; k++) w += GlyphAdvance(cps[k]);
+    return w * size / font.baseSize + (count - 1) * spacing;
+}
 
-        if (*p == ' ') p++;
+// ─────────────────────────────────────────────────────────────────────────────
+// Text layout cache – word wrapping measured once per (string, size, wrap width)
+// and kept as codepoint runs with their positions, so a hovered label or
+// tooltip is a lookup plus one DrawTextCodepoints per word. Words are spaced
+// the way DrawTextEx spaces a whole line. Strings are keyed by address; any
+// edit or delete bumps text_generation, which drops every cached layout.
+// ─────────────────────────────────────────────────────────────────────────────
+#define LAYOUT_SLOTS 8
+
+typedef struct { int first, count, line; float x; } TextRun;   // codepoints[first..first+count)
+
+typedef struct {
+    const char *text;
+    int len;
+    unsigned generation, last_used;
+    float size, spacing, wrap;
+    int *codepoints;
+    int cp_count, cp_cap;
+    TextRun *runs;
+    int run_count, run_cap;
+    int lines;       // lines with text, counted the way the tooltip sizes itself
+    float width;     // widest line
+} TextLayout;
+
+static TextLayout layout_cache[LAYOUT_SLOTS];
+static unsigned layout_clock = 0;
+
+static bool LayoutPush(TextLayout *l, int first, int count, int line, float x)
+{
+    if (l->run_count == l->run_cap) {
+        int cap = l->run_cap ? l->run_cap * 2 : 32;
+        if (!GrowColumn(&l->runs, sizeof(TextRun), cap)) return false;
+        l->run_cap = cap;
+    }
+    l->runs[l->run_count++] = (TextRun){ first, count, line, x };
+    return true;
+}
+
+static void LayoutBuild(TextLayout *l)
+{
+    l->cp_count = l->run_count = l->lines = 0;
+    l->width = 0.0f;
+    if (l->cp_cap < l->len + 1) {
+        if (!GrowColumn(&l->codepoints, sizeof(int), l->len + 1)) { l->len = 0; return; }
+        l->cp_cap = l->len + 1;
     }
-    if (lineW > 0.0f) totalH += lineH;
+
+    int space_cp = ' ';
+    float gap = MeasureCodepoints(&space_cp, 1, l->size, l->spacing) + 2.0f * l->spacing;
+    const char *p = l->text, *end = l->text + l->len;
+    int line = 0;
+    float line_w = 0.0f;
+
+    while (p < end) {
+        if (*p == '\n') { line++; line_w = 0.0f; p++; continue; }
+        if (*p == ' ')  { p++; continue; }
+
+        int first = l->cp_count;
+        while (p < end && *p != ' ' && *p != '\n') {
+            int size = 1;
+            l->codepoints[l->cp_count++] = GetCodepointNext(p, &size);
+            p += size > 0 ? size : 1;
+        }
+        float word_w = MeasureCodepoints(l->codepoints + first, l->cp_count - first, l->size, l->spacing);
+        float space = line_w > 0.0f ? gap : 0.0f;
+
+        if (l->wrap > 0.0f && line_w > 0.0f && line_w + space + word_w > l->wrap) {
+            line++;
+            line_w = space = 0.0f;
+        }
+
+        if (!LayoutPush(l, first, l->cp_count - first, line, line_w + space)) break;
+        line_w += space + word_w;
+        if (line_w > l->width) l->width = line_w;
+    }
+    l->lines = line + (line_w > 0.0f ? 1 : 0);
+}
+
+// Layout of text[0..len) wrapped at `wrap` pixels (0 = only at newlines)
+static const TextLayout *LayoutText(const char *text, int len, float size, float spacing, float wrap)
+{
+    layout_clock++;
+    TextLayout *slot = &layout_cache[0];
+    for (int k = 0; k < LAYOUT_SLOTS; k++) {
+        TextLayout *l = &layout_cache[k];
+        if (l->text == text && l->len == len && l->generation == text_generation &&
+            l->size == size && l->spacing == spacing && l->wrap == wrap) {
+            l->last_used = layout_clock;
+            return l;
+        }
+        if (l->last_used < slot->last_used) slot = l;
+    }
+
+    slot->text = text;
+    slot->len = len;
+    slot->generation = text_generation;
+    slot->size = size;
+    slot->spacing = spacing;
+    slot->wrap = wrap;
+    slot->last_used = layout_clock;
+    LayoutBuild(slot);
+    return slot;
+}
+
+static void DrawTextLayout(const TextLayout *l, Vector2 pos, float line_h, Color tint)
+{
+    for (int r = 0; r < l->run_count; r++) {
+        const TextRun *run = &l->runs[r];
+        DrawTextCodepoints(font, l->codepoints + run->first, run->count,
+                           (Vector2){ pos.x + run->x, pos.y + run->line * line_h }, l->size, l->spacing, tint);
+    }
+}
+
+void DrawGlobalTooltip(void)
+{
+    if (!g_show_tooltip) return;
+
+    const float fontSize = 19.0f;
+    const float spacing  = 1.2f;
+    const float maxWidth = 640.0f;
+    const float pad      = 24.0f;
+    const float lineH    = fontSize + 10.0f;
+
+    // Long descriptions are cut at 511 bytes, on a character boundary
+    int len = (int)strnlen(g_tooltip_text, 511);
+    while (len > 0 && ((unsigned char)g_tooltip_text[len] & 0xC0) == 0x80) len--;
+    const TextLayout *layout = LayoutText(g_tooltip_text, len, fontSize, spacing, maxWidth);
+    float totalH = pad * 2.0f + layout->lines * lineH;
 
     // ── Position tooltip ──
     float x = g_tooltip_x + 30.0f;
@@ -712,52 +1324,16 @@ void DrawGlobalTooltip(void)
     DrawRectangleRoundedLinesEx(rect, 0.3f, 16, 4.0f, (Color){100, 200, 255, 255});
 
     // ── Draw wrapped text ──
-    float cx = x + pad;
-    float cy = y + pad;
-    p = g_tooltip_text;
-    lineW = 0.0f;
-
-    while (*p) {
-        if (*p == '\n') {
-            cy += lineH;
-            cx = x + pad;
-            lineW = 0.0f;
-            p++;
-            continue;
-        }
-
-        const char* start = p;
-        while (*p && *p != ' ' && *p != '\n') p++;
-        int len = (int)(p - start);
-        if (len == 0) { p++; continue; }
-
-        char word[512];
-        snprintf(word, sizeof(word), "%.*s", len, start);
-
-        float wordW = MeasureTextEx(font, word, fontSize, spacing).x;
-        float spaceW = (lineW > 0.0f) ? MeasureTextEx(font, " ", fontSize, spacing).x : 0.0f;
-
-        if (lineW + spaceW + wordW > w - pad*2 && lineW > 0.0f) {
-            cy += lineH;
-            cx = x + pad;
-            lineW = 0.0f;
-        }
-
-        DrawTextEx(font, word, (Vector2){cx + 1, cy + 1}, fontSize, spacing, Fade(BLACK, 0.8f));
-        DrawTextEx(font, word, (Vector2){cx,     cy},     fontSize, spacing, WHITE);
-
-        cx += wordW + spaceW;
-        lineW += wordW + spaceW;
-
-        if (*p == ' ') p++;
-    }
+    DrawTextLayout(layout, (Vector2){x + pad + 1, y + pad + 1}, lineH, Fade(BLACK, 0.8f));
+    DrawTextLayout(layout, (Vector2){x + pad,     y + pad},     lineH, WHITE);
 
     // Reset for next frame
     g_show_tooltip = false;
 }
 
-void DrawUI(void) {
-    int W = GetScreenWidth(), H = GetScreenHeight();
+// The header's fixed part: background and labels (cached, see RefreshLayers)
+void DrawHeaderPanel(void) {
+    int W = GetScreenWidth();
 
     DrawRectangle(0, 0, W, 140, (Color){20,20,35,255});  // taller header
     DrawLine(0, 140, W, 140, (Color){60,60,80,255});
@@ -766,26 +1342,527 @@ void DrawUI(void) {
     DrawTextEx(font, "Start:",       (Vector2){620, 30}, 22, 1, (Color){200,200,220,255});
     DrawTextEx(font, "End:",         (Vector2){900, 30}, 22, 1, (Color){200,200,220,255});
     DrawTextEx(font, "Description:", (Vector2){100, 90}, 22, 1, (Color){200,200,220,255});
+    DrawTextEx(font, "Find:",        (Vector2){1185, 30}, 22, 1, (Color){200,200,220,255});
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Cached layers – the grid and the header background only change with the view
+// or the window, so they are drawn into render textures and reused until then.
+// ─────────────────────────────────────────────────────────────────────────────
+typedef struct {
+    time_t view_start;
+    double pixels_per_year;
+    int width, height;
+    int64_t today;   // the grid's TODAY line moves at midnight
+} LayerKey;
+
+typedef struct {
+    RenderTexture2D target;
+    LayerKey key;
+    bool valid;
+} CachedLayer;
+
+static CachedLayer grid_layer, header_layer;
+
+// Draws into the layer again if its key changed. Alpha accumulates as ONE,
+// ONE_MINUS_SRC_ALPHA, which leaves the texture premultiplied, so DrawLayer
+// composites it exactly like drawing the same shapes straight to the screen.
+static void RefreshLayer(CachedLayer *l, LayerKey key, int height, void (*draw)(void))
+{
+    if (l->valid && memcmp(&l->key, &key, sizeof key) == 0) return;
+    if (l->target.id == 0 || l->target.texture.width != key.width || l->target.texture.height != height) {
+        if (l->target.id) UnloadRenderTexture(l->target);
+        l->target = LoadRenderTexture(key.width, height);
+        if (l->target.id == 0) { l->valid = false; return; }
+    }
+
+    BeginTextureMode(l->target);
+        ClearBackground(BLANK);
+        rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+            draw();
+        EndBlendMode();
+    EndTextureMode();
+    l->key = key;
+    l->valid = true;
+}
+
+void DrawLayer(const CachedLayer *l)
+{
+    if (!l->valid) return;
+    Texture2D tex = l->target.texture;
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+        DrawTextureRec(tex, (Rectangle){0, 0, (float)tex.width, -(float)tex.height}, (Vector2){0, 0}, WHITE);
+    EndBlendMode();
+}
+
+static LayerKey CurrentView(void)
+{
+    LayerKey k;
+    memset(&k, 0, sizeof k);   // compared with memcmp, padding included
+    k.view_start = tracker.view_start;
+    k.pixels_per_year = tracker.pixels_per_year;
+    k.width = GetScreenWidth();
+    k.height = GetScreenHeight();
+    int y, m, d;
+    k.today = LocalCivil(time(NULL), &y, &m, &d);
+    return k;
+}
+
+// Call before BeginDrawing: texture mode must not nest inside the frame's scissor
+void RefreshLayers(void)
+{
+    LayerKey view = CurrentView();
+    RefreshLayer(&grid_layer, view, view.height, DrawTimelineGrid);
+
+    LayerKey size;
+    memset(&size, 0, sizeof size);
+    size.width = view.width;
+    size.height = view.height;
+    RefreshLayer(&header_layer, size, (int)timeline_y + 1, DrawHeaderPanel);
+}
+
+void UnloadLayers(void)
+{
+    if (grid_layer.target.id) UnloadRenderTexture(grid_layer.target);
+    if (header_layer.target.id) UnloadRenderTexture(header_layer.target);
+    grid_layer = header_layer = (CachedLayer){0};
+}
+
+void DrawUI(void) {
+    int H = GetScreenHeight();
+
+    DrawLayer(&header_layer);
 
     DrawTextInput(&name_input,   font);
     DrawTextInput(&start_input,  font);
     DrawTextInput(&end_input,    font);
     DrawTextInput(&desc_input,   font);
+    DrawTextInput(&search_input, font);
 
     DrawTextEx(font,
-        "LClick=select • Drag edges=resize • RDrag=pan • Scroll=zoom • Enter=new • Del=remove",
+        "LClick=select • Drag edges=resize • RDrag=pan • Scroll=zoom • Enter=new • Del=remove • Ctrl+Z/Y=undo/redo • Drop .csv/.ics=import • F6=export",
         (Vector2){15, H-32}, 18, 1, (Color){160,180,220,255});
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// Layer chips – one per timeline file in the top-left corner of the timeline;
+// clicking one hides or shows that file's events. Only there when files were
+// opened on top of timetracker.json.
+// ─────────────────────────────────────────────────────────────────────────────
+#define CHIP_H 26.0f
+
+static bool chips_took_click = false;
+
+static uint32_t HiddenLayers(void)
+{
+    uint32_t mask = 0;
+    for (int k = 0; k < layer_count; k++) mask |= (uint32_t)layers[k].hidden << k;
+    return mask;
+}
+
+// Chip k's rectangle; x carries the left edge from one chip to the next
+static Rectangle LayerChipRect(int k, float *x)
+{
+    Rectangle r = { *x, timeline_y + 8.0f, MeasureTextEx(font, layers[k].name, 18, 1).x + 34.0f, CHIP_H };
+    *x += r.width + 6.0f;
+    return r;
+}
+
+static int LayerChipAt(Vector2 p)
+{
+    float x = 10.0f;
+    for (int k = 0; k < layer_count && layer_count > 1; k++)
+        if (CheckCollisionPointRec(p, LayerChipRect(k, &x))) return k;
+    return -1;
+}
+
+bool LayerChipsOwnMouse(void)
+{
+    return chips_took_click || LayerChipAt(GetMousePosition()) >= 0;
+}
+
+void HandleLayerChips(void)
+{
+    chips_took_click = false;
+    if (!IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) return;
+    int k = LayerChipAt(GetMousePosition());
+    if (k < 0) return;
+
+    chips_took_click = true;
+    LayerSetHidden(k, !layers[k].hidden);
+    if (selected >= 0 && layers[tracker.layer[selected]].hidden) {
+        selected = -1;
+        dragging = -1;
+    }
+}
+
+void DrawLayerChips(void)
+{
+    if (layer_count < 2) return;
+    Vector2 mouse = GetMousePosition();
+    float x = 10.0f;
+    for (int k = 0; k < layer_count; k++) {
+        Rectangle r = LayerChipRect(k, &x);
+        EventColor c = layers[k].color;
+        Color swatch = k ? (Color){c.r, c.g, c.b, 255} : (Color){240,40,40,255};
+        bool hidden = layers[k].hidden;
+
+        DrawRectangleRounded(r, 0.5f, 8, CheckCollisionPointRec(mouse, r) ? (Color){45,45,80,235} : (Color){25,25,50,235});
+        DrawCircle((int)(r.x + 13), (int)(r.y + CHIP_H / 2), 5, hidden ? Fade(swatch, 0.25f) : swatch);
+        DrawTextEx(font, layers[k].name, (Vector2){r.x + 24, r.y + 4}, 18, 1,
+                   hidden ? (Color){110,110,140,255} : (Color){220,220,240,255});
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// File drop – .csv and .ics files dropped on the window are imported into the
+// timeline (CSV columns are found by their header names)
+// ─────────────────────────────────────────────────────────────────────────────
+void HandleDroppedFiles(void)
+{
+    if (!IsFileDropped()) return;
+    FilePathList files = LoadDroppedFiles();
+    int first = tracker.editable;
+    for (unsigned int k = 0; k < files.count; k++) {
+        const char *path = files.paths[k];
+        int added = -1;
+        if (IsFileExtension(path, ".csv")) {
+            CsvColumns cols = { .name = -1, .desc = -1, .start = -1, .end = -1, .header = true };
+            added = ImportCsv(path, &cols);
+        }
+        else if (IsFileExtension(path, ".ics")) added = ImportIcs(path);
+        else TraceLog(LOG_WARNING, "Can only import .csv and .ics files, not %s", path);
+        if (added >= 0) TraceLog(LOG_INFO, "Imported %d events from %s", added, path);
+    }
+    UnloadDroppedFiles(files);
+
+    for (int i = first; i < tracker.editable; i++) {
+        GlyphRequireText(EventName(i));
+        GlyphRequireText(EventDesc(i));
+    }
+    // Overlay events moved to make room, and undo history was dropped
+    selected = -1;
+    dragging = -1;
+    last_selected = -2;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Command line – "timeTracker events|totals|conflicts ..." answers one query from
+// the timeline file and exits before any window is created; "timeTracker
+// export ..." renders a range to PNG/SVG through a hidden window. The file is
+// only read: the journal is replayed in memory and nothing is written back.
+// ─────────────────────────────────────────────────────────────────────────────
+static const char CLI_USAGE[] =
+    "usage: %s events    FROM TO   [--tsv] [--file TIMELINE.json]\n"
+    "       %s totals    FROM TO   [--tsv] [--file TIMELINE.json]\n"
+    "       %s conflicts [FROM TO] [--tsv] [--file TIMELINE.json]\n"
+    "FROM and TO are local times, \"YYYY-MM-DD\" or \"YYYY-MM-DD HH:MM\"; events\n"
+    "touching either end count. Output is JSON unless --tsv is given.\n";
+
+bool IsQueryCommand(const char *arg)
+{
+    return strcmp(arg, "events") == 0 || strcmp(arg, "totals") == 0 || strcmp(arg, "conflicts") == 0;
+}
+
+// Exit status: 0 answered, 1 the timeline couldn't be read, 2 bad arguments
+int RunQuery(int argc, char **argv)
+{
+    const char *cmd = argv[1], *file = "timetracker.json", *range[2] = { NULL, NULL };
+    bool tsv = false, bad = false;
+    int given = 0;
+    for (int k = 2; k < argc; k++) {
+        if (strcmp(argv[k], "--tsv") == 0) tsv = true;
+        else if (strcmp(argv[k], "--file") == 0 && k + 1 < argc) file = argv[++k];
+        else if (given < 2 && argv[k][0] != '-') range[given++] = argv[k];
+        else bad = true;
+    }
+    if (bad || given == 1 || (given == 0 && strcmp(cmd, "conflicts") != 0)) {
+        fprintf(stderr, CLI_USAGE, argv[0], argv[0], argv[0]);
+        return 2;
+    }
+
+    time_t from = TIME_MIN, to = (time_t)INT64_MAX;
+    if (given == 2) {
+        from = ParseDateTime(range[0]);
+        to = ParseDateTime(range[1]);
+        if (!from || !to || to < from) {
+            fprintf(stderr, "%s: bad range %s .. %s\n", argv[0], range[0], range[1]);
+            return 2;
+        }
+    }
+    if (!PeekTimeline(file, false)) {
+        fprintf(stderr, "%s: can't read %s\n", argv[0], file);
+        return 1;
+    }
+
+    int rows = cmd[0] == 'e' ? QueryEvents(stdout, from, to, tsv)
+             : cmd[0] == 't' ? QueryTotals(stdout, from, to, tsv)
+             :                 QueryConflicts(stdout, from, to, tsv);
+    return rows < 0 || fflush(stdout) != 0 ? 1 : 0;
+}
+
+#define EXPORT_WIDTH      12000     // default poster width
+#define EXPORT_MAX_WIDTH  1000000   // a band of this is ~500 MB
+#define EXPORT_MIN_HEIGHT 900       // the window's height, so short ranges keep the grid's proportions
+
+static const char EXPORT_USAGE[] =
+    "usage: %s export FROM TO [--width PX] [--file TIMELINE.json] OUT.png|OUT.svg...\n"
+    "Renders FROM..TO (local times, as for queries) PX wide, %d by default.\n";
+
+// Exit status: 0 written, 1 something couldn't be read or written, 2 bad arguments
+int RunExport(int argc, char **argv)
+{
+    const char *file = "timetracker.json", *range[2] = { NULL, NULL }, *png = NULL, *svg = NULL;
+    long width = EXPORT_WIDTH;
+    bool bad = false;
+    int given = 0;
+    for (int k = 2; k < argc; k++) {
+        char *end = NULL;
+        if (strcmp(argv[k], "--width") == 0 && k + 1 < argc) {
+            width = strtol(argv[++k], &end, 10);
+            bad |= *end != '\0' || width < 1 || width > EXPORT_MAX_WIDTH;
+        }
+        else if (strcmp(argv[k], "--file") == 0 && k + 1 < argc) file = argv[++k];
+        else if (argv[k][0] == '-') bad = true;
+        else if (given < 2) range[given++] = argv[k];
+        else if (IsFileExtension(argv[k], ".png") && !png) png = argv[k];
+        else if (IsFileExtension(argv[k], ".svg") && !svg) svg = argv[k];
+        else bad = true;
+    }
+    if (bad || given < 2 || (!png && !svg)) {
+        fprintf(stderr, EXPORT_USAGE, argv[0], EXPORT_WIDTH);
+        return 2;
+    }
+    time_t from = ParseDateTime(range[0]), to = ParseDateTime(range[1]);
+    if (!from || !to || to <= from) {
+        fprintf(stderr, "%s: bad range %s .. %s\n", argv[0], range[0], range[1]);
+        return 2;
+    }
+    if (!PeekTimeline(file, true)) {
+        fprintf(stderr, "%s: can't read %s\n", argv[0], file);
+        return 1;
+    }
+
+    double pixels_per_year = width * (365.25 * 86400.0) / difftime(to, from);
+    int height = ExportHeight(from, to, EXPORT_MIN_HEIGHT);
+
+    // The PNG needs a GL context for its render texture, the SVG nothing at all
+    SetTraceLogLevel(LOG_WARNING);
+    if (png) {
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(640, 480, "Lifetime Visual Time Tracker");
+        if (!IsWindowReady()) {
+            fprintf(stderr, "%s: no OpenGL context for %s\n", argv[0], png);
+            return 1;
+        }
+        LoadUiFont();
+    }
+    bool ok = ExportRange(png, svg, from, (int)width, height, pixels_per_year);
+    if (png) {
+        UnloadEventBatch();
+        UnloadFont(font);
+        UnloadGlyphCache();
+        CloseWindow();
+    }
+    return ok ? 0 : 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Search box – results follow every keystroke (SearchQuery is well under a
+// millisecond on a million events); Enter or a click on a result centers the
+// view on that event and selects it
+// ─────────────────────────────────────────────────────────────────────────────
+#define SEARCH_SHOWN 10
+#define SEARCH_ROW_H 26.0f
+
+static struct {
+    char query[MAX_INPUT];
+    int  hits[SEARCH_SHOWN + 1];   // one extra to tell "10" from "10+"
+    int  count, highlight;
+    unsigned text_generation;      // what the results were computed against
+    int  tracker_count;
+    uint64_t journal_seq;
+    uint32_t hidden_layers;
+    bool partial;                  // a short query ran out of time; more may match
+    bool open;                     // as of the last HandleSearch
+    bool took_click;               // this frame's click went to the list
+} search_box;
+
+static int SearchShown(void) { return search_box.count < SEARCH_SHOWN ? search_box.count : SEARCH_SHOWN; }
+
+// Below the search input, stretched left up to the description box
+static Rectangle SearchListRect(void)
+{
+    Rectangle in = search_input.rect;
+    float x = desc_input.rect.x + desc_input.rect.width + 10.0f;
+    return (Rectangle){ x, in.y + in.height + 4.0f, in.x + in.width - x, 36.0f + SearchShown() * SEARCH_ROW_H };
+}
+
+// True while the pointer belongs to the result list, including the click that closed it
+bool SearchOwnsMouse(void)
+{
+    return search_box.took_click || (search_box.open && CheckCollisionPointRec(GetMousePosition(), SearchListRect()));
+}
+
+static void SearchJump(int i)
+{
+    double secs_per_px = (365.25 * 86400.0) / tracker.pixels_per_year;
+    double visible = GetScreenWidth() * secs_per_px;
+    double len = difftime(tracker.end[i], tracker.start[i]);
+    // Centered if it fits, otherwise starting a tenth into the screen
+    tracker.view_start = tracker.start[i] - (time_t)(len < visible * 0.8 ? (visible - len) / 2 : visible * 0.1);
+    selected = i;
+    search_input.active = false;
+}
+
+// Call after UpdateTextInput(&search_input) and before HandleKeyboardShortcuts.
+// Clicks are checked against the list as it was drawn, since the click that
+// picks a result also takes the focus off the input.
+void HandleSearch(void)
+{
+    search_box.took_click = false;
+    Vector2 mouse = GetMousePosition();
+    if (search_box.open && CheckCollisionPointRec(mouse, SearchListRect()) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        int row = (int)((mouse.y - SearchListRect().y - 30.0f) / SEARCH_ROW_H);
+        search_box.took_click = true;
+        if (row >= 0 && row < SearchShown()) SearchJump(search_box.hits[row]);
+    }
+
+    search_box.open = search_input.active && search_input.text[0];
+    if (!search_box.open) return;
+
+    // Every keystroke, and whenever the store changed under the results
+    if (strcmp(search_box.query, search_input.text) || search_box.text_generation != text_generation ||
+        search_box.tracker_count != tracker.count || search_box.journal_seq != JournalSeq() ||
+        search_box.hidden_layers != HiddenLayers()) {
+        strcpy(search_box.query, search_input.text);
+        search_box.text_generation = text_generation;
+        search_box.tracker_count = tracker.count;
+        search_box.journal_seq = JournalSeq();
+        search_box.hidden_layers = HiddenLayers();
+        search_box.count = SearchQuery(search_box.query, search_box.hits, SEARCH_SHOWN + 1);
+        search_box.partial = SearchPartial();
+        search_box.highlight = 0;
+    }
+
+    Rectangle list = SearchListRect();
+    if (CheckCollisionPointRec(mouse, list)) {
+        int row = (int)((mouse.y - list.y - 30.0f) / SEARCH_ROW_H);
+        if (row >= 0 && row < SearchShown()) search_box.highlight = row;
+    }
+    if (IsKeyPressed(KEY_DOWN) && search_box.highlight < SearchShown() - 1) search_box.highlight++;
+    if (IsKeyPressed(KEY_UP)   && search_box.highlight > 0) search_box.highlight--;
+    if (IsKeyPressed(KEY_ENTER) && SearchShown() > 0) {
+        SearchJump(search_box.hits[search_box.highlight]);
+        search_box.open = false;
+    }
+}
+
+void DrawSearchResults(void)
+{
+    if (!search_box.open) return;
+    Rectangle list = SearchListRect();
+    DrawRectangleRec(list, (Color){25, 25, 50, 245});
+    DrawRectangleLinesEx(list, 1, (Color){90, 90, 140, 255});
+
+    const char *summary = search_box.partial               ? (search_box.count ? TextFormat("%d so far, keep typing", search_box.count)
+                                                                               : "Keep typing...") :
+                          search_box.count == 0            ? "No matches" :
+                          search_box.count > SEARCH_SHOWN  ? TextFormat("First %d matches", SEARCH_SHOWN) :
+                          search_box.count == 1            ? "1 match" : TextFormat("%d matches", search_box.count);
+    DrawTextEx(font, summary, (Vector2){list.x + 10, list.y + 6}, 18, 1, (Color){140, 140, 180, 255});
+
+    BeginScissorMode((int)list.x, (int)list.y, (int)list.width, (int)list.height);
+    for (int r = 0; r < SearchShown(); r++) {
+        int i = search_box.hits[r];
+        float y = list.y + 30.0f + r * SEARCH_ROW_H;
+        if (r == search_box.highlight)
+            DrawRectangle((int)list.x + 1, (int)y, (int)list.width - 2, (int)SEARCH_ROW_H, (Color){50, 80, 140, 255});
+
+        char date[16];
+        strftime(date, sizeof(date), "%Y-%m-%d", SafeLocalTime(&tracker.start[i]));
+        Vector2 ds = MeasureTextEx(font, date, 18, 1);
+        DrawTextEx(font, date, (Vector2){list.x + list.width - ds.x - 10, y + 4}, 18, 1, (Color){100, 220, 255, 255});
+
+        // Names run under the date rather than wrapping
+        BeginScissorMode((int)list.x, (int)y, (int)(list.width - ds.x - 20), (int)SEARCH_ROW_H);
+            const char *name = EventName(i)[0] ? EventName(i) : "Untitled";
+            DrawTextEx(font, name, (Vector2){list.x + 10, y + 3}, 20, 1, WHITE);
+        EndScissorMode();
+    }
+    EndScissorMode();
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Text Input Implementation
 // ─────────────────────────────────────────────────────────────────────────────
-static float TextWidthUpTo(Font font, const char *text, int count, float size, float spacing) {
-    if (count <= 0) return 0;
-    char tmp[MAX_INPUT];
-    int len = (int)fminf(count, strlen(text));
-    strncpy(tmp, text, len); tmp[len] = '\0';
-    return MeasureTextEx(font, tmp, size, spacing).x;
+// Rebuilds the per-codepoint arrays after text was replaced wholesale
+static void TextInputReflow(TextInput *ti)
+{
+    int n = 0, b = 0;
+    float x = 0.0f;
+    while (ti->text[b] && n < MAX_INPUT) {
+        int size = 1;
+        int cp = GetCodepointNext(ti->text + b, &size);
+        ti->cp_byte[n] = b;
+        ti->cp_x[n++] = x;
+        x += GlyphAdvance(cp);
+        b += size > 0 ? size : 1;
+    }
+    ti->cp_byte[n] = b;
+    ti->cp_x[n] = x;
+    ti->cp_count = n;
+    if (ti->cursor_pos > b) ti->cursor_pos = b;
+}
+
+// Codepoint index of a byte offset (the one containing it)
+static int TextInputCodepointAt(const TextInput *ti, int byte)
+{
+    int lo = 0, hi = ti->cp_count;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (ti->cp_byte[mid] <= byte) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+}
+
+// Width of the first k codepoints, as MeasureTextEx would report it
+static float TextInputWidth(const TextInput *ti, int k, float size, float spacing)
+{
+    if (k <= 0 || font.baseSize <= 0) return 0.0f;
+    return ti->cp_x[k] * size / font.baseSize + (k - 1) * spacing;
+}
+
+// Inserts one encoded codepoint at the caret and shifts the arrays after it
+static void TextInputInsert(TextInput *ti, int codepoint, const char *utf8, int len)
+{
+    int pos = ti->cursor_pos, k = TextInputCodepointAt(ti, pos), n = ti->cp_count;
+    memmove(ti->text + pos + len, ti->text + pos, ti->cp_byte[n] - pos + 1);
+    memcpy(ti->text + pos, utf8, len);
+
+    float adv = GlyphAdvance(codepoint);
+    memmove(&ti->cp_byte[k + 1], &ti->cp_byte[k], (n - k + 1) * sizeof(int));
+    memmove(&ti->cp_x[k + 1],    &ti->cp_x[k],    (n - k + 1) * sizeof(float));
+    for (int j = k + 1; j <= n + 1; j++) { ti->cp_byte[j] += len; ti->cp_x[j] += adv; }
+    ti->cp_count = n + 1;
+    ti->cursor_pos = pos + len;
+}
+
+// Removes the codepoints covering bytes [from, to) and shifts the arrays back
+static void TextInputErase(TextInput *ti, int from, int to)
+{
+    int k0 = TextInputCodepointAt(ti, from), k1 = TextInputCodepointAt(ti, to), n = ti->cp_count;
+    if (k1 <= k0) return;
+    int bytes = ti->cp_byte[k1] - ti->cp_byte[k0];
+    float width = ti->cp_x[k1] - ti->cp_x[k0];
+    memmove(ti->text + ti->cp_byte[k0], ti->text + ti->cp_byte[k1], ti->cp_byte[n] - ti->cp_byte[k1] + 1);
+
+    memmove(&ti->cp_byte[k0], &ti->cp_byte[k1], (n - k1 + 1) * sizeof(int));
+    memmove(&ti->cp_x[k0],    &ti->cp_x[k1],    (n - k1 + 1) * sizeof(float));
+    n -= k1 - k0;
+    for (int j = k0; j <= n; j++) { ti->cp_byte[j] -= bytes; ti->cp_x[j] -= width; }
+    ti->cp_count = n;
 }
 
 void DrawTextInput(TextInput *ti, Font font) {
@@ -796,13 +1873,14 @@ void DrawTextInput(TextInput *ti, Font font) {
     const char *display = ti->text[0] ? ti->text : "(empty)";
     DrawTextEx(font, display, (Vector2){ti->rect.x + 12, ti->rect.y + 12}, 20, 1, WHITE);
     if (ti->active && ((int)(GetTime() * 2) % 2 == 0)) {
-        float x = ti->rect.x + 12 + TextWidthUpTo(font, ti->text, ti->cursor_pos, 20, 1);
+        float x = ti->rect.x + 12 + TextInputWidth(ti, TextInputCodepointAt(ti, ti->cursor_pos), 20, 1);
         DrawRectangle((int)x, (int)ti->rect.y + 12, 2, 20, WHITE);
     }
 }
 
 void UpdateTextInput(TextInput *ti, Font font)
 {
+    (void)font;   // widths come from the glyph advance table
     Vector2 mouse = GetMousePosition();
 
     // ── Focus & cursor placement (unchanged) ─────────────────────
@@ -814,13 +1892,13 @@ void UpdateTextInput(TextInput *ti, Font font)
             float rel_x = mouse.x - (ti->rect.x + 12);
             if (rel_x < 0) ti->cursor_pos = 0;
             else {
-                int low = 0, high = (int)strlen(ti->text);
+                int low = 0, high = ti->cp_count;
                 while (low < high) {
                     int mid = (low + high + 1) / 2;
-                    if (TextWidthUpTo(font, ti->text, mid, 20, 1) <= rel_x) low = mid;
+                    if (TextInputWidth(ti, mid, 20, 1) <= rel_x) low = mid;
                     else high = mid - 1;
                 }
-                ti->cursor_pos = low;
+                ti->cursor_pos = ti->cp_byte[low];
             }
         }
     }
@@ -829,7 +1907,7 @@ void UpdateTextInput(TextInput *ti, Font font)
     // ── UNICODE CHARACTER INPUT (manual UTF-8 encoding) ──────────
     int codepoint = GetCharPressed();
     while (codepoint > 0) {
-        if (codepoint >= 32 && strlen(ti->text) < MAX_INPUT - 8) {
+        if (codepoint >= 32 && ti->cp_byte[ti->cp_count] < MAX_INPUT - 8) {
             char utf8[8] = {0};
             int len = 0;
 
@@ -854,11 +1932,7 @@ void UpdateTextInput(TextInput *ti, Font font)
             }
 
             // Insert UTF-8 bytes
-            memmove(ti->text + ti->cursor_pos + len,
-                    ti->text + ti->cursor_pos,
-                    strlen(ti->text + ti->cursor_pos) + 1);
-            memcpy(ti->text + ti->cursor_pos, utf8, len);
-            ti->cursor_pos += len;
+            if (len > 0) TextInputInsert(ti, codepoint, utf8, len);
         }
         codepoint = GetCharPressed();
     }
@@ -880,28 +1954,19 @@ void UpdateTextInput(TextInput *ti, Font font)
         if (currentKey != repeatKey) {
             // First press — immediate action
             if (currentKey == KEY_BACKSPACE && ti->cursor_pos > 0) {
-                int pos = ti->cursor_pos;
-                do { pos--; } while (pos > 0 && (ti->text[pos] & 0xC0) == 0x80);
-                memmove(ti->text + pos, ti->text + ti->cursor_pos, strlen(ti->text + ti->cursor_pos) + 1);
+                int pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos - 1)];
+                TextInputErase(ti, pos, ti->cursor_pos);
                 ti->cursor_pos = pos;
             }
-            else if (currentKey == KEY_DELETE && ti->cursor_pos < (int)strlen(ti->text)) {
-                int pos = ti->cursor_pos;
-                int end = pos;
-                do { end++; } while (end < (int)strlen(ti->text) && (ti->text[end] & 0xC0) == 0x80);
-                if (end > pos) {
-                    memmove(ti->text + pos, ti->text + end, strlen(ti->text + end) + 1);
-                }
+            else if (currentKey == KEY_DELETE && ti->cursor_pos < ti->cp_byte[ti->cp_count]) {
+                int k = TextInputCodepointAt(ti, ti->cursor_pos);
+                TextInputErase(ti, ti->cp_byte[k], ti->cp_byte[k + 1]);
             }
             else if (currentKey == KEY_LEFT && ti->cursor_pos > 0) {
-                int pos = ti->cursor_pos;
-                do { pos--; } while (pos > 0 && (ti->text[pos] & 0xC0) == 0x80);
-                ti->cursor_pos = pos;
+                ti->cursor_pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos - 1)];
             }
-            else if (currentKey == KEY_RIGHT && ti->cursor_pos < (int)strlen(ti->text)) {
-                int pos = ti->cursor_pos;
-                do { pos++; } while (pos < (int)strlen(ti->text) && (ti->text[pos] & 0xC0) == 0x80);
-                ti->cursor_pos = pos;
+            else if (currentKey == KEY_RIGHT && ti->cursor_pos < ti->cp_byte[ti->cp_count]) {
+                ti->cursor_pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos) + 1];
             }
 
             repeatKey = currentKey;
@@ -912,26 +1977,19 @@ void UpdateTextInput(TextInput *ti, Font font)
             repeatTimer -= GetFrameTime();
             if (repeatTimer <= 0.0f) {
                 if (currentKey == KEY_BACKSPACE && ti->cursor_pos > 0) {
-                    int pos = ti->cursor_pos;
-                    do { pos--; } while (pos > 0 && (ti->text[pos] & 0xC0) == 0x80);
-                    memmove(ti->text + pos, ti->text + ti->cursor_pos, strlen(ti->text + ti->cursor_pos) + 1);
+                    int pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos - 1)];
+                    TextInputErase(ti, pos, ti->cursor_pos);
                     ti->cursor_pos = pos;
                 }
-                else if (currentKey == KEY_DELETE && ti->cursor_pos < (int)strlen(ti->text)) {
-                    int pos = ti->cursor_pos;
-                    int end = pos;
-                    do { end++; } while (end < (int)strlen(ti->text) && (ti->text[end] & 0xC0) == 0x80);
-                    if (end > pos) memmove(ti->text + pos, ti->text + end, strlen(ti->text + end) + 1);
+                else if (currentKey == KEY_DELETE && ti->cursor_pos < ti->cp_byte[ti->cp_count]) {
+                    int k = TextInputCodepointAt(ti, ti->cursor_pos);
+                    TextInputErase(ti, ti->cp_byte[k], ti->cp_byte[k + 1]);
                 }
                 else if (currentKey == KEY_LEFT && ti->cursor_pos > 0) {
-                    int pos = ti->cursor_pos;
-                    do { pos--; } while (pos > 0 && (ti->text[pos] & 0xC0) == 0x80);
-                    ti->cursor_pos = pos;
+                    ti->cursor_pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos - 1)];
                 }
-                else if (currentKey == KEY_RIGHT && ti->cursor_pos < (int)strlen(ti->text)) {
-                    int pos = ti->cursor_pos;
-                    do { pos++; } while (pos < (int)strlen(ti->text) && (ti->text[pos] & 0xC0) == 0x80);
-                    ti->cursor_pos = pos;
+                else if (currentKey == KEY_RIGHT && ti->cursor_pos < ti->cp_byte[ti->cp_count]) {
+                    ti->cursor_pos = ti->cp_byte[TextInputCodepointAt(ti, ti->cursor_pos) + 1];
                 }
 
                 repeatTimer = REPEAT_INTERVAL;
@@ -945,18 +2003,20 @@ void UpdateTextInput(TextInput *ti, Font font)
 
     // ── Home / End / Ctrl+V (unchanged) ──────────────────────────
     if (IsKeyPressed(KEY_HOME)) ti->cursor_pos = 0;
-    if (IsKeyPressed(KEY_END))  ti->cursor_pos = (int)strlen(ti->text);
+    if (IsKeyPressed(KEY_END))  ti->cursor_pos = ti->cp_byte[ti->cp_count];
 
     if ((IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && IsKeyPressed(KEY_V)) {
         const char *clip = GetClipboardText();
         if (clip) {
             size_t len = strlen(clip);
-            size_t space = MAX_INPUT - 1 - strlen(ti->text);
+            size_t space = MAX_INPUT - 1 - ti->cp_byte[ti->cp_count];
             if (len > space) len = space;
-            memmove(ti->text + ti->cursor_pos + len, ti->text + ti->cursor_pos, strlen(ti->text + ti->cursor_pos) + 1);
+            while (len > 0 && ((unsigned char)clip[len] & 0xC0) == 0x80) len--;   // whole characters only
+            memmove(ti->text + ti->cursor_pos + len, ti->text + ti->cursor_pos, ti->cp_byte[ti->cp_count] - ti->cursor_pos + 1);
             memcpy(ti->text + ti->cursor_pos, clip, len);
             ti->cursor_pos += (int)len;
             ti->text[MAX_INPUT-1] = '\0';
+            TextInputReflow(ti);
         }
     }
 }
@@ -1016,7 +2076,7 @@ void DrawStatusBar(void)
 
     // ── Selected event (centered, optional) ───────────────────────
     if (selected >= 0 && selected < tracker.count) {
-        const char* name = tracker.entries[selected].name[0] ? tracker.entries[selected].name : "Untitled";
+        const char* name = EventName(selected)[0] ? EventName(selected) : "Untitled";
         char txt[128];
         snprintf(txt, sizeof(txt), "Selected: %s", name);
         Vector2 ts = MeasureTextEx(font, txt, 19, 1.0f);
@@ -1031,103 +2091,271 @@ void DrawStatusBar(void)
 void DrawHoveredEventNameOnTop(void)
 {
     Vector2 mouse = GetMousePosition();
-    if (mouse.y < timeline_y) return;
+    if (mouse.y < timeline_y || SearchOwnsMouse() || LayerChipsOwnMouse()) return;
+
+    // Same bar geometry as DrawEvents(), hit-tested by the core
+    TimelineView view = { tracker.view_start, tracker.pixels_per_year, (float)GetScreenWidth(), events_start_y, 10.0f };
+    int i = EventPick(&view, mouse.x, mouse.y);
+    if (i < 0) return;
+
+    double secs_from_view = difftime(tracker.start[i], tracker.view_start);
+    float x_start = (float)(secs_from_view * tracker.pixels_per_year / (365.25 * 86400.0));
+    float duration_px = DurationYears(i) * tracker.pixels_per_year;
+    if (duration_px < 2.0f) duration_px = 2.0f;
+    float draw_x1 = fmaxf(x_start, 0.0f);
+    float draw_len = fminf(x_start + duration_px, GetScreenWidth()) - draw_x1;
+    float y = events_start_y + tracker.track[i] * 10.0f;
+
+    const char* name = EventName(i)[0] ? EventName(i) : "Untitled";
+    float fs = 13.0f;
+
+    const TextLayout *layout = LayoutText(name, (int)strlen(name), fs, 1.0f, 0.0f);
+    Vector2 full_size = { layout->width, fs * (layout->lines > 0 ? layout->lines : 1) };
+    float visible_width = draw_len;
+
+    bool needs_expand = (full_size.x > visible_width - 10.0f);
+    float box_width = needs_expand ? full_size.x + 16.0f : visible_width;
+    float box_left = needs_expand ?
+        draw_x1 + (visible_width - box_width) * 0.5f :
+        draw_x1;
+
+    // Clamp to screen
+    if (box_left < 10) box_left = 10;
+    if (box_left + box_width > GetScreenWidth() - 10)
+        box_left = GetScreenWidth() - box_width - 10;
+
+    float textY = y - 7;
+    float pad = 7.0f;
+    Rectangle bg = { box_left - pad, textY - pad, box_width + pad*2, full_size.y + pad*2 };
+
+    // Draw background + border
+    DrawRectangleRounded(bg, 0.4f, 12, (Color){0, 0, 0, 240});
+    DrawRectangleRoundedLinesEx(bg, 0.4f, 12, 2.0f, (Color){100, 180, 255, 255});
+
+    // Draw name with shadow
+    DrawTextLayout(layout, (Vector2){box_left + 1, textY + 1}, fs, Fade(BLACK, 0.8f));
+    DrawTextLayout(layout, (Vector2){box_left,     textY},     fs, WHITE);
+}
 
-    // Reuse the same hover detection logic from DrawEvents()
-    for (int i = 0; i < tracker.count; i++) {
-        Entry *e = &tracker.entries[i];
+// ─────────────────────────────────────────────────────────────────────────────
+// Frame profiler – each phase of the loop is timed into a rolling window of its
+// last PROF_HISTORY runs, which F3 shows as p50/p99, and into a ring of spans
+// that F4 writes out as a Chrome trace (chrome://tracing or ui.perfetto.dev)
+// ─────────────────────────────────────────────────────────────────────────────
+typedef enum {
+    PHASE_FRAME, PHASE_PAN_ZOOM, PHASE_SELECT_DRAG, PHASE_TEXT_INPUT,
+    PHASE_EVENTS, PHASE_GRID, PHASE_TOOLTIP, PHASE_STATUS_BAR, PHASE_COUNT
+} ProfPhase;
 
-        double secs_from_view = difftime(e->start, tracker.view_start);
-        float x_start = (float)(secs_from_view * tracker.pixels_per_year / (365.25 * 86400.0));
-        float duration_px = e->duration_years * tracker.pixels_per_year;
-        if (duration_px < 2.0f) duration_px = 2.0f;
+static const char *PHASE_NAMES[PHASE_COUNT] = {
+    "Frame", "HandlePanningAndZooming", "HandleSelectionAndDragging", "UpdateTextInput",
+    "DrawEvents", "DrawTimelineGrid", "DrawGlobalTooltip", "DrawStatusBar"
+};
 
-        float draw_x1 = fmaxf(x_start, 0.0f);
-        float draw_len = fminf(x_start + duration_px, GetScreenWidth()) - draw_x1;
-        if (draw_len <= 0.0f) continue;
+#define PROF_HISTORY     240      // ~4 s of drawn frames at 60 fps
+#define PROF_TRACE_SPANS 32768    // oldest spans get overwritten
 
-        float y = events_start_y + g_track_of_event[i] * 10.0f;
-        Rectangle hit = { draw_x1, y - 7, draw_len, 16 };
-        bool hovered = CheckCollisionPointRec(mouse, hit);
+typedef struct { double begin, dur; int phase; } ProfSpan;
 
-        if (hovered) {
-            const char* name = e->name[0] ? e->name : "Untitled";
-            float fs = 13.0f;
+typedef struct {
+    bool   overlay;
+    double open[PHASE_COUNT];      // start of a running phase, 0 if not running
+    double acc[PHASE_COUNT];       // time in each phase this iteration (inputs run 4x)
+    bool   ran[PHASE_COUNT];
+    float  history[PHASE_COUNT][PROF_HISTORY];   // ms
+    int    head[PHASE_COUNT], filled[PHASE_COUNT];
+    ProfSpan *trace;
+    int    trace_head, trace_count;
+} Profiler;
 
-            Vector2 full_size = MeasureTextEx(font, name, fs, 1.0f);
-            float visible_width = draw_len;
+static Profiler prof = {0};
 
-            bool needs_expand = (full_size.x > visible_width - 10.0f);
-            float box_width = needs_expand ? full_size.x + 16.0f : visible_width;
-            float box_left = needs_expand ?
-                draw_x1 + (visible_width - box_width) * 0.5f :
-                draw_x1;
+static void ProfBegin(ProfPhase p) { prof.open[p] = GetTime(); }
 
-            // Clamp to screen
-            if (box_left < 10) box_left = 10;
-            if (box_left + box_width > GetScreenWidth() - 10)
-                box_left = GetScreenWidth() - box_width - 10;
+static void ProfEnd(ProfPhase p)
+{
+    if (prof.open[p] == 0) return;
+    double dur = GetTime() - prof.open[p];
+    prof.acc[p] += dur;
+    prof.ran[p] = true;
+
+    if (!prof.trace) prof.trace = malloc(PROF_TRACE_SPANS * sizeof(ProfSpan));
+    if (prof.trace) {
+        prof.trace[prof.trace_head] = (ProfSpan){ prof.open[p], dur, p };
+        prof.trace_head = (prof.trace_head + 1) % PROF_TRACE_SPANS;
+        if (prof.trace_count < PROF_TRACE_SPANS) prof.trace_count++;
+    }
+    prof.open[p] = 0;
+}
 
-            float textY = y - 7;
-            float pad = 7.0f;
-            Rectangle bg = { box_left - pad, textY - pad, box_width + pad*2, full_size.y + pad*2 };
+// Commits this iteration's times if it drew a frame. Skipped iterations only
+// poll input, so their (idle) input phases are dropped along with the frame
+// rather than dragging every percentile down; the trace still has their spans.
+static void ProfFrameEnd(bool drawn)
+{
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        if (drawn && prof.ran[p]) {
+            prof.history[p][prof.head[p]] = (float)(prof.acc[p] * 1000.0);
+            prof.head[p] = (prof.head[p] + 1) % PROF_HISTORY;
+            if (prof.filled[p] < PROF_HISTORY) prof.filled[p]++;
+        }
+        prof.acc[p] = 0;
+        prof.ran[p] = false;
+        prof.open[p] = 0;
+    }
+}
+
+// Oldest span first; timestamps are seconds since InitWindow, in µs
+static void ProfDumpTrace(const char *file)
+{
+    FILE *f = fopen(file, "w");
+    if (!f) { TraceLog(LOG_WARNING, "Could not write trace %s", file); return; }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int first = (prof.trace_head - prof.trace_count + PROF_TRACE_SPANS) % PROF_TRACE_SPANS;
+    for (int k = 0; k < prof.trace_count; k++) {
+        const ProfSpan *s = &prof.trace[(first + k) % PROF_TRACE_SPANS];
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}\n",
+                k ? "," : "", PHASE_NAMES[s->phase], s->begin * 1e6, s->dur * 1e6);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    TraceLog(LOG_INFO, "Wrote %d spans to %s", prof.trace_count, file);
+}
 
-            // Draw background + border
-            DrawRectangleRounded(bg, 0.4f, 12, (Color){0, 0, 0, 240});
-            DrawRectangleRoundedLinesEx(bg, 0.4f, 12, 2.0f, (Color){100, 180, 255, 255});
+// F3 toggles the overlay, F4 dumps the trace; true if the screen needs a redraw
+static bool ProfilerKeys(void)
+{
+    if (IsKeyPressed(KEY_F4)) ProfDumpTrace("timetracker-trace.json");
+    if (!IsKeyPressed(KEY_F3)) return false;
+    prof.overlay = !prof.overlay;
+    return true;
+}
 
-            // Draw name with shadow
-            DrawTextEx(font, name, (Vector2){box_left + 1, textY + 1}, fs, 1.0f, Fade(BLACK, 0.8f));
-            DrawTextEx(font, name, (Vector2){box_left,     textY},     fs, 1.0f, WHITE);
+static int CompareFloat(const void *a, const void *b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
 
-            break;  // only one event can be hovered
-        }
+void DrawProfiler(void)
+{
+    DrawFPS(10, 10);
+    if (!prof.overlay) return;
+
+    const float size = 18.0f, row = 22.0f, w = 430.0f;
+    const float x = GetScreenWidth() - w - 10.0f, y = timeline_y + 10.0f;
+    DrawRectangleRounded((Rectangle){x, y, w, row * (PHASE_COUNT + 1) + 16.0f}, 0.06f, 8, (Color){20, 20, 45, 235});
+    DrawTextEx(font, "phase",  (Vector2){x + 12,  y + 8}, size, 1.0f, (Color){140, 140, 180, 255});
+    DrawTextEx(font, "p50 ms", (Vector2){x + 290, y + 8}, size, 1.0f, (Color){140, 140, 180, 255});
+    DrawTextEx(font, "p99 ms", (Vector2){x + 360, y + 8}, size, 1.0f, (Color){140, 140, 180, 255});
+
+    float sorted[PROF_HISTORY];
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        float ry = y + 8 + row * (p + 1);
+        DrawTextEx(font, PHASE_NAMES[p], (Vector2){x + 12, ry}, size, 1.0f, (Color){220, 220, 240, 255});
+        int n = prof.filled[p];
+        if (n == 0) continue;
+
+        memcpy(sorted, prof.history[p], n * sizeof(float));
+        qsort(sorted, n, sizeof(float), CompareFloat);
+        float p50 = sorted[n / 2], p99 = sorted[(int)(n * 0.99f)];
+        // Anything that eats a big share of a 60 fps frame shows up red
+        Color hot = p99 > 8.0f ? (Color){255, 120, 120, 255} : (Color){140, 230, 160, 255};
+        DrawTextEx(font, TextFormat("%6.2f", p50), (Vector2){x + 290, ry}, size, 1.0f, (Color){220, 220, 240, 255});
+        DrawTextEx(font, TextFormat("%6.2f", p99), (Vector2){x + 360, ry}, size, 1.0f, hot);
     }
 }
 
-int main(void) {
-    const int W = 1500, H = 900;
-
-    InitWindow(W, H, "Lifetime Visual Time Tracker");
-    SetTargetFPS(60);
+// ─────────────────────────────────────────────────────────────────────────────
+// Frame pacing – a frame is only drawn when something that shows on screen
+// changed (view, data, inputs, mouse, caret blink, window size). In between the
+// loop sleeps: in raylib's event waiting mode when nothing is pending, so an idle
+// window costs no CPU, or for one frame's time while a save, a blinking caret or
+// a held button still needs the loop to come around.
+// ─────────────────────────────────────────────────────────────────────────────
+typedef struct {
+    LayerKey view;
+    Vector2 mouse;
+    int selected, dragging, count, buttons;
+    uint32_t hidden_layers;
+    uint64_t journal_seq;
+    unsigned text_generation;
+    uint32_t inputs;   // hash of the text inputs' text, caret and focus
+    int blink;
+} FrameState;
+
+static FrameState last_frame;
+static bool event_waiting = false;
+
+static uint32_t HashInput(uint32_t h, const TextInput *ti)
+{
+    for (const char *c = ti->text; *c; c++) h = (h ^ (unsigned char)*c) * 16777619u;
+    h = (h ^ (uint32_t)ti->cursor_pos) * 16777619u;
+    return (h ^ (uint32_t)ti->active) * 16777619u;
+}
 
+static bool AnyInputActive(void)
+{
+    return name_input.active || start_input.active || end_input.active || desc_input.active || search_input.active;
+}
 
-   // ────────────────────── PERFECT UNICODE FONT LOADING (NO MORE ????) ──────────────────────
-    const char* preferred_paths[] = {
-        "resources/NotoSans-Regular.ttf",                 // ← your bundled copy
-        "/usr/share/fonts/noto/NotoSans-Regular.ttf",
-        "/usr/share/fonts/TTF/DejaVuSans.ttf",
-        NULL
-    };
+// Compares what the screen shows against the last drawn frame
+bool FrameChanged(bool force)
+{
+    FrameState f;
+    memset(&f, 0, sizeof f);
+    f.view = CurrentView();
+    f.mouse = GetMousePosition();
+    f.selected = selected;
+    f.dragging = dragging;
+    f.count = tracker.count;
+    f.hidden_layers = HiddenLayers();
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_MIDDLE; b++) f.buttons |= IsMouseButtonDown(b) << b;
+    f.journal_seq = JournalSeq();
+    f.text_generation = text_generation;
+    f.inputs = HashInput(HashInput(HashInput(HashInput(2166136261u, &name_input), &start_input), &end_input), &desc_input);
+    f.inputs = (HashInput(f.inputs, &search_input) ^ (uint32_t)search_box.highlight) * 16777619u;
+    f.blink = AnyInputActive() ? (int)(GetTime() * 2) % 2 : 0;
+
+    bool changed = force || IsWindowResized() || memcmp(&f, &last_frame, sizeof f) != 0;
+    last_frame = f;
+    return changed;
+}
 
-    font = (Font){0};
+// Nothing to draw this time around: sleep until there may be
+void FrameSkip(void)
+{
+    if (!event_waiting) WaitTime(1.0 / 60.0);
+    PollInputEvents();
+}
 
-    for (int i = 0; preferred_paths[i]; i++) {
-        if (FileExists(preferred_paths[i])) {
-            // Load with a large glyph count to cover full Unicode (up to ~65k glyphs)
-            font = LoadFontEx(preferred_paths[i], 32, NULL, 65536);
-            if (font.texture.id != 0) {
-                SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);
-                TraceLog(LOG_INFO, "Loaded font: %s → FULL UNICODE SUPPORT", preferred_paths[i]);
-                break;
-            }
-        }
-    }
+// Event waiting makes both PollInputEvents and EndDrawing block until input
+// arrives, so it is only on while no timer (autosave, caret, key repeat) runs
+void UpdateEventWaiting(void)
+{
+    bool idle = !JournalBusy() && !AnyInputActive();
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_MIDDLE && idle; b++) idle = !IsMouseButtonDown(b);
+    if (idle == event_waiting) return;
+    if (idle) EnableEventWaiting(); else DisableEventWaiting();
+    event_waiting = idle;
+}
 
-    // Absolute last resort
-    if (font.texture.id == 0) {
-        font = GetFontDefault();
-        TraceLog(LOG_WARNING, "Using raylib default font – limited Unicode");
-    }
-    // ──────────────────────────────────────────────────────────────────────────────────────
+int main(int argc, char **argv) {
+    const int W = 1500, H = 900;
+    if (argc > 1 && IsQueryCommand(argv[1])) return RunQuery(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "export") == 0) return RunExport(argc, argv);
 
-    // Absolute last resort
-    if (font.texture.id == 0) {
-        font = GetFontDefault();
-        TraceLog(LOG_WARNING, "Using raylib default font – limited Unicode");
+    InitWindow(W, H, "Lifetime Visual Time Tracker");
+    SetTargetFPS(60);
+    LoadUiFont();
+    // Any files named on the command line open on top as read-only layers
+    LoadTimelines("timetracker.json", (const char *const *)argv + 1, argc - 1);
+    for (int i = 0; i < tracker.count; i++) {
+        GlyphRequireText(EventName(i));
+        GlyphRequireText(EventDesc(i));
     }
-    // ──────────────────────────────────────────────────────────────────────────────────────    
-    LoadTracker("timetracker.json");
+    GlyphCacheFlush();
     tracker.pixels_per_year = 700.0f;
 
     // ───── CENTER TODAY ON SCREEN (your original logic — untouched) ─────
@@ -1154,22 +2382,36 @@ int main(void) {
     InitTextInput(&start_input, (Rectangle){680, 20, 200, 48}, today_str);
     InitTextInput(&end_input,   (Rectangle){960, 20, 200, 48}, today_str);
     InitTextInput(&desc_input, (Rectangle){180, 80, 980, 48}, "");
+    InitTextInput(&search_input, (Rectangle){1250, 20, 235, 48}, "");
 
     while (!WindowShouldClose()) {
+        ProfBegin(PHASE_FRAME);
         // ────────────────────── INPUT ORDER (THIS IS THE FIX) ──────────────────────
         clicked_on_event_this_frame = false;        // ← MUST BE FIRST
 
+        ProfBegin(PHASE_PAN_ZOOM);
         HandlePanningAndZooming();                 // ← NOW RUNS UNBLOCKED
+        ProfEnd(PHASE_PAN_ZOOM);
 
+        ProfBegin(PHASE_SELECT_DRAG);
         HandleSelectionAndDragging();              // ← sets clicked_on_event_this_frame if needed
+        ProfEnd(PHASE_SELECT_DRAG);
 
+        ProfBegin(PHASE_TEXT_INPUT);
         UpdateTextInput(&name_input, font);
         UpdateTextInput(&start_input, font);
         UpdateTextInput(&end_input, font);
         UpdateTextInput(&desc_input, font);
+        UpdateTextInput(&search_input, font);
+        ProfEnd(PHASE_TEXT_INPUT);
+        HandleSearch();
+        HandleLayerChips();
+        HandleDroppedFiles();
         HandleKeyboardShortcuts();
+        bool profiler_toggled = ProfilerKeys();
 
         if (selected != last_selected) {
+            if (dragging < 0) HistoryFlush();   // a drag that just selected its event is still going
             SyncInputsToSelected();
             last_selected = selected;
         }
@@ -1184,6 +2426,18 @@ int main(void) {
                 strcpy(last_end,   end_input.text);
             }
         }
+        JournalPoll();
+        bool glyphs_added = GlyphCacheFlush();   // whatever got measured this frame, before it's drawn
+
+        UpdateEventWaiting();
+        if (!FrameChanged(glyphs_added || profiler_toggled)) {
+            ProfFrameEnd(false);
+            FrameSkip();
+            continue;
+        }
+        ProfBegin(PHASE_GRID);
+        RefreshLayers();
+        ProfEnd(PHASE_GRID);
 
         // ────────────────────── DRAWING ──────────────────────
         BeginDrawing();
@@ -1191,21 +2445,37 @@ int main(void) {
 
             DrawUI();
 
+            ProfBegin(PHASE_EVENTS);
             BeginScissorMode(0, (int)timeline_y, GetScreenWidth(), GetScreenHeight() - (int)timeline_y);
                 DrawEvents();                          // ← now runs AFTER panning
             EndScissorMode();
+            ProfEnd(PHASE_EVENTS);
 
-            DrawTimelineGrid();
+            ProfBegin(PHASE_GRID);
+            DrawLayer(&grid_layer);
+            ProfEnd(PHASE_GRID);
+            DrawLayerChips();
             DrawCursorIndicator();
+            DrawSearchResults();
+            ProfBegin(PHASE_TOOLTIP);
             DrawGlobalTooltip();                        // ← last = solid & on top
+            ProfEnd(PHASE_TOOLTIP);
+            ProfBegin(PHASE_STATUS_BAR);
             DrawStatusBar();
+            ProfEnd(PHASE_STATUS_BAR);
             DrawHoveredEventNameOnTop();
-            DrawFPS(10, 10);
+            DrawProfiler();
+            ProfEnd(PHASE_FRAME);
+            ProfFrameEnd(true);
         EndDrawing();
     }
         
-    SaveTracker("timetracker.json");
+    CloseTimeline();
+    UnloadEventBatch();
+    UnloadLayers();
     UnloadFont(font);
+    UnloadGlyphCache();
+    free(prof.trace);
     CloseWindow();
     return 0;
 }
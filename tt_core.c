@@ -0,0 +1,3859 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "tt_core.h"
+
+Tracker tracker = {0};
+unsigned text_generation = 0;
+TimelineLayer layers[MAX_LAYERS] = { { .name = "timeline" } };
+int layer_count = 1;
+
+static void IndexInsert(int i);
+static void IndexRemove(int i);
+static void IndexRenumber(int from, int to);
+static void SearchChanged(int i);
+static void SearchReset(void);
+static void TrackerCompactText(void);
+
+// What TraceLog(LOG_WARNING, ...) would print, without needing raylib
+static void Warn(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fputs("WARNING: ", stderr);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+// Seconds on a monotonic clock; only differences matter
+static double NowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Same distribution as raylib's GetRandomValue with its default rand() backend
+static int RandomValue(int min, int max)
+{
+    return rand() % (max - min + 1) + min;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Calendar – civil dates as plain integer math (days-from-civil and its inverse)
+// plus a table of the local zone's UTC-offset changes, built once by probing
+// localtime_r. Converting between time_t and local Y/M/D is then a binary
+// search and a few divisions instead of a trip through mktime/localtime.
+// ─────────────────────────────────────────────────────────────────────────────
+#define ZONE_PROBE_STEP (7 * 86400)                    // DST changes are months apart
+#define ZONE_SPAN       ((time_t)100 * 365 * 86400)   // grow the table this far past a query
+#define ZONE_LIMIT      ((time_t)20000 * 365 * 86400) // beyond ±20000 years, reuse the edge offset
+
+static int64_t FloorDiv(int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+
+// Days since 1970-01-01 of a proleptic Gregorian date (m = 1..12)
+static int64_t DaysFromCivil(int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void CivilFromDays(int64_t z, int *y, int *m, int *d)
+{
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp  = (5 * doy + 2) / 153;
+    *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+// offset[k] (seconds east of UTC) applies from at[k] up to at[k+1]
+typedef struct {
+    time_t *at;
+    int    *offset;
+    int count, capacity;
+    time_t lo, hi;   // range the table was probed over
+} ZoneTable;
+
+static ZoneTable zone;
+
+static int ProbeOffset(time_t t)
+{
+    struct tm tm;
+    return localtime_r(&t, &tm) ? (int)tm.tm_gmtoff : 0;
+}
+
+static void ZonePush(time_t at, int offset)
+{
+    if (zone.count == zone.capacity) {
+        int cap = zone.capacity ? zone.capacity * 2 : 256;
+        if (!GrowColumn(&zone.at, sizeof(time_t), cap) || !GrowColumn(&zone.offset, sizeof(int), cap)) return;
+        zone.capacity = cap;
+    }
+    zone.at[zone.count] = at;
+    zone.offset[zone.count++] = offset;
+}
+
+// Probes (from, to] and appends every offset change, to the second
+static void ZoneProbe(time_t from, time_t to)
+{
+    int cur = zone.offset[zone.count - 1];
+    for (time_t t = from; t < to; ) {
+        time_t next = t + ZONE_PROBE_STEP < to ? t + ZONE_PROBE_STEP : to;
+        int off = ProbeOffset(next);
+        if (off != cur) {
+            time_t a = t, b = next;   // offset is cur at a, differs at b
+            while (b - a > 1) {
+                time_t mid = a + (b - a) / 2;
+                if (ProbeOffset(mid) == cur) a = mid; else b = mid;
+            }
+            cur = ProbeOffset(b);
+            ZonePush(b, cur);
+            next = b;
+        }
+        t = next;
+    }
+}
+
+// Grows the probed range to cover t (plus some slack), probing only the new part
+static void ZoneCover(time_t t)
+{
+    if (zone.count == 0) {
+        zone.lo = zone.hi = t;
+        ZonePush(t, ProbeOffset(t));
+    }
+    if (t > zone.hi) {
+        time_t hi = t + ZONE_SPAN > ZONE_LIMIT ? ZONE_LIMIT : t + ZONE_SPAN;
+        ZoneProbe(zone.hi, hi);
+        zone.hi = hi;
+    }
+    if (t < zone.lo) {
+        // Probe the new stretch into a fresh table, then put the old entries after it
+        ZoneTable old = zone;
+        time_t lo = t - ZONE_SPAN < -ZONE_LIMIT ? -ZONE_LIMIT : t - ZONE_SPAN;
+        zone = (ZoneTable){ .lo = lo, .hi = old.hi };
+        ZonePush(lo, ProbeOffset(lo));
+        ZoneProbe(lo, old.lo);
+        for (int k = 0; k < old.count; k++)
+            if (zone.count && zone.offset[zone.count - 1] != old.offset[k] && old.at[k] > zone.at[zone.count - 1])
+                ZonePush(old.at[k], old.offset[k]);
+        free(old.at);
+        free(old.offset);
+    }
+}
+
+// Table entry in force at t, or -1 if the table couldn't be allocated
+static int ZoneIndex(time_t t)
+{
+    if (t < -ZONE_LIMIT) t = -ZONE_LIMIT;
+    if (t >  ZONE_LIMIT) t =  ZONE_LIMIT;
+    if (zone.count == 0 || t < zone.lo || t > zone.hi) ZoneCover(t);
+    if (zone.count == 0) return -1;
+
+    // Callers mostly walk forward through time, so try the last hit and its successor first
+    static int hint = 0;
+    for (int k = hint; k <= hint + 1 && k < zone.count; k++)
+        if (zone.at[k] <= t && (k + 1 == zone.count || t < zone.at[k + 1])) return hint = k;
+
+    int a = 0, b = zone.count - 1;
+    while (a < b) {
+        int mid = (a + b + 1) / 2;
+        if (zone.at[mid] <= t) a = mid; else b = mid - 1;
+    }
+    return hint = a;
+}
+
+// Seconds to add to a UTC time to get local wall-clock time
+static int ZoneOffsetAt(time_t t)
+{
+    int k = ZoneIndex(t);
+    return k < 0 ? 0 : zone.offset[k];
+}
+
+// Local wall-clock seconds (as if the zone were UTC) back to time_t. A wall time
+// that happens twice (clocks going back) gives the first instant; one skipped
+// by clocks going forward lands just after the gap, as mktime does.
+time_t UtcFromLocal(int64_t local)
+{
+    int k = ZoneIndex((time_t)local - ZoneOffsetAt((time_t)local));
+    if (k < 0) return (time_t)local;
+
+    // Only the offsets on either side of the nearest change can apply
+    bool found = false;
+    time_t first = 0, latest = TIME_MIN;
+    for (int j = k - 1; j <= k + 1; j++) {
+        if (j < 0 || j >= zone.count) continue;
+        time_t t = (time_t)(local - zone.offset[j]);
+        if (t > latest) latest = t;
+        bool in_force = (j == 0 || zone.at[j] <= t) && (j + 1 == zone.count || t < zone.at[j + 1]);
+        if (in_force && (!found || t < first)) { first = t; found = true; }
+    }
+    return found ? first : latest;
+}
+
+time_t LocalFromCivil(int y, int m, int d, int hour, int min)
+{
+    return UtcFromLocal(DaysFromCivil(y, m, d) * 86400 + hour * 3600 + min * 60);
+}
+
+// Local date of t; returns the day number so callers can step by whole days
+int64_t LocalCivil(time_t t, int *y, int *m, int *d)
+{
+    int64_t days = FloorDiv((int64_t)t + ZoneOffsetAt(t), 86400);
+    CivilFromDays(days, y, m, d);
+    return days;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Date parsing
+// ─────────────────────────────────────────────────────────────────────────────
+// Canonical "YYYY-MM-DD HH:MM" / "YYYY-MM-DD": checks all digit and separator
+// positions at once, eight bytes per word
+static bool ParseDateTimeFixed(const char *s, int f[5]) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    size_t n = strnlen(s, 17);
+    if (n != 10 && n != 16) return false;
+    char buf[16] = {0};
+    memcpy(buf, s, n);
+    uint64_t lo, hi;
+    memcpy(&lo, buf, 8);
+    memcpy(&hi, buf + 8, 8);
+
+    const uint64_t zeros = 0x3030303030303030ULL, sixes = 0x0606060606060606ULL, highs = 0xF0F0F0F0F0F0F0F0ULL;
+    // Digit lanes: "YYYY-MM-" and "DD HH:MM" (or "DD" alone)
+    const uint64_t lo_digits = 0x00FFFF00FFFFFFFFULL;
+    const uint64_t hi_digits = n == 16 ? 0xFFFF00FFFF00FFFFULL : 0x000000000000FFFFULL;
+    const uint64_t lo_seps   = 0x2D00002D00000000ULL;                            // '-' at 4 and 7
+    const uint64_t hi_seps   = n == 16 ? 0x00003A0000200000ULL : 0;              // ' ' at 10, ':' at 13
+
+    bool ok = (lo & highs & lo_digits) == (zeros & lo_digits) && ((lo + sixes) & highs & lo_digits) == (zeros & lo_digits) &&
+              (hi & highs & hi_digits) == (zeros & hi_digits) && ((hi + sixes) & highs & hi_digits) == (zeros & hi_digits) &&
+              (lo & ~lo_digits) == lo_seps && (hi & ~hi_digits) == hi_seps;
+    if (!ok) return false;
+
+    const unsigned char *u = (const unsigned char*)buf;
+    f[0] = (u[0] & 15) * 1000 + (u[1] & 15) * 100 + (u[2] & 15) * 10 + (u[3] & 15);
+    f[1] = (u[5] & 15) * 10 + (u[6] & 15);
+    f[2] = (u[8] & 15) * 10 + (u[9] & 15);
+    f[3] = n == 16 ? (u[11] & 15) * 10 + (u[12] & 15) : 0;
+    f[4] = n == 16 ? (u[14] & 15) * 10 + (u[15] & 15) : 0;
+    return f[1] >= 1 && f[1] <= 12 && f[2] >= 1 && f[2] <= 31 && f[3] <= 23 && f[4] <= 59;
+#else
+    (void)s; (void)f;
+    return false;
+#endif
+}
+
+// One numeric field the way strptime reads it: leading spaces, then digits while
+// they fit in `width` and the value can still stay <= hi
+static bool ReadDateField(const char **p, int lo, int hi, int width, int *out) {
+    const char *q = *p;
+    while (*q == ' ' || (*q >= '\t' && *q <= '\r')) q++;
+    if (*q < '0' || *q > '9') return false;
+    int v = 0;
+    do v = v * 10 + (*q++ - '0');
+    while (--width > 0 && v * 10 <= hi && *q >= '0' && *q <= '9');
+    if (v < lo || v > hi) return false;
+    *p = q;
+    *out = v;
+    return true;
+}
+
+// Accepts what strptime("%Y-%m-%d %H:%M") or strptime("%Y-%m-%d") would and
+// stores the wall-clock time as seconds since 1970-01-01 00:00 local. Touches
+// no shared state, so loader threads can call it; UtcFromLocal cannot.
+static bool ParseWallClock(const char *s, int64_t *local) {
+    int f[5] = {0};
+    if (!ParseDateTimeFixed(s, f)) {
+        const char *p = s;
+        f[3] = f[4] = 0;
+        if (!ReadDateField(&p, 0, 9999, 4, &f[0]) || *p++ != '-' ||
+            !ReadDateField(&p, 1, 12, 2, &f[1])   || *p++ != '-' ||
+            !ReadDateField(&p, 1, 31, 2, &f[2])) return false;
+        while (*p == ' ' || (*p >= '\t' && *p <= '\r')) p++;
+        // An hour without minutes still counts, as it did when strptime filled the tm
+        if (ReadDateField(&p, 0, 23, 2, &f[3]) && *p++ == ':') ReadDateField(&p, 0, 59, 2, &f[4]);
+    }
+    *local = DaysFromCivil(f[0], f[1], f[2]) * 86400 + f[3] * 3600 + f[4] * 60;
+    return true;
+}
+
+// ParseWallClock as local time. Returns 0 for anything it doesn't accept.
+time_t ParseDateTime(const char *s) {
+    int64_t local;
+    return ParseWallClock(s, &local) ? UtcFromLocal(local) : 0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// String arena – a store's names and descriptions sit back to back in one
+// growing buffer and events hold 32-bit offsets into it. Strings are interned:
+// a hash table finds an existing copy before anything is appended, so a name
+// used by a thousand events is stored once, and two events have the same text
+// exactly when their handles are equal. Nothing is freed one string at a time;
+// once edits have left the tracker's arena about half garbage, the strings
+// still in use move to a fresh one.
+// ─────────────────────────────────────────────────────────────────────────────
+#define TEXT_NONE       UINT32_MAX   // empty table slot, or out of memory
+#define TEXT_SLACK      65536        // garbage always tolerated before compacting
+
+// FNV-1a
+static uint32_t TextHash(const char *s, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t k = 0; k < n; k++) h = (h ^ (unsigned char)s[k]) * 16777619u;
+    return h;
+}
+
+// Slot holding the string s (n bytes), or the empty slot where it would go
+static uint32_t TextSlot(const TextArena *a, const char *s, size_t n)
+{
+    uint32_t mask = a->slots - 1, k = TextHash(s, n) & mask;
+    while (a->table[k] != TEXT_NONE && memcmp(a->data + a->table[k], s, n + 1) != 0) k = (k + 1) & mask;
+    return k;
+}
+
+static bool TextTableGrow(TextArena *a)
+{
+    uint32_t slots = a->slots ? a->slots * 2 : 1024;
+    TextId *table = malloc((size_t)slots * sizeof(TextId));
+    if (!table) return false;
+    memset(table, 0xFF, (size_t)slots * sizeof(TextId));
+
+    TextId *old = a->table;
+    uint32_t old_slots = a->slots;
+    a->table = table;
+    a->slots = slots;
+    for (uint32_t k = 0; k < old_slots; k++) {
+        if (old[k] == TEXT_NONE) continue;
+        const char *t = a->data + old[k];
+        a->table[TextSlot(a, t, strlen(t))] = old[k];
+    }
+    free(old);
+    return true;
+}
+
+// Makes room for `more` bytes. The tracker's strings may move, which is what
+// text_generation tells cached pointers.
+static bool TextReserve(TextArena *a, size_t more)
+{
+    if (a->used + more <= a->capacity) return true;
+    if (more > UINT32_MAX - a->used) return false;   // handles are 32-bit
+    size_t cap = a->capacity ? a->capacity : 4096;
+    while (cap < a->used + more) cap *= 2;
+    if (cap > UINT32_MAX) cap = UINT32_MAX;
+
+    char *p = realloc(a->data, cap);
+    if (!p) return false;
+    if (p != a->data && a == &tracker.text) text_generation++;
+    a->data = p;
+    a->capacity = (uint32_t)cap;
+    return true;
+}
+
+// Handle of s in the arena, appending it if it isn't there yet; TEXT_NONE on OOM.
+// s must not point into the arena itself.
+static TextId TextIntern(TextArena *a, const char *s)
+{
+    if (!s) s = "";
+    if ((size_t)(a->count + 1) * 4 > (size_t)a->slots * 3 && !TextTableGrow(a)) return TEXT_NONE;
+    size_t n = strlen(s);
+    uint32_t k = TextSlot(a, s, n);
+    if (a->table[k] != TEXT_NONE) return a->table[k];
+    if (!TextReserve(a, n + 1)) return TEXT_NONE;
+
+    TextId id = a->used;
+    memcpy(a->data + id, s, n + 1);
+    a->used += (uint32_t)(n + 1);
+    a->table[k] = id;
+    a->count++;
+    return id;
+}
+
+// Handle of the string already stored at `id` that the table knows, entering
+// `id` itself when its text is new (for arenas loaded wholesale)
+static TextId TextAdopt(TextArena *a, TextId id)
+{
+    if ((size_t)(a->count + 1) * 4 > (size_t)a->slots * 3 && !TextTableGrow(a)) return TEXT_NONE;
+    const char *t = a->data + id;
+    uint32_t k = TextSlot(a, t, strlen(t));
+    if (a->table[k] == TEXT_NONE) { a->table[k] = id; a->count++; }
+    return a->table[k];
+}
+
+static void TextReset(TextArena *a)
+{
+    if (a->table) memset(a->table, 0xFF, (size_t)a->slots * sizeof(TextId));
+    a->used = a->live = a->count = 0;
+}
+
+static void TextFree(TextArena *a)
+{
+    free(a->data);
+    free(a->table);
+    *a = (TextArena){0};
+}
+
+// The event store's own text, valid until the next string is stored
+const char *EventName(int i) { return tracker.text.data + tracker.name[i]; }
+const char *EventDesc(int i) { return tracker.text.data + tracker.desc[i]; }
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Event store
+// ─────────────────────────────────────────────────────────────────────────────
+static char *DupText(const char *s)
+{
+    if (!s) s = "";
+    size_t n = strlen(s) + 1;
+    char *d = malloc(n);
+    if (d) memcpy(d, s, n);
+    return d;
+}
+
+// Reallocates one column in place; on failure the old (still valid) block is kept
+bool GrowColumn(void *column, size_t elem_size, int cap)
+{
+    void **col = column;
+    void *p = realloc(*col, (size_t)cap * elem_size);
+    if (!p) return false;
+    *col = p;
+    return true;
+}
+
+static bool StoreReserve(Tracker *t, int want)
+{
+    if (want <= t->capacity) return true;
+    int cap = t->capacity ? t->capacity : 256;
+    while (cap < want) cap *= 2;
+
+    if (!GrowColumn(&t->start, sizeof(time_t),        cap) ||
+        !GrowColumn(&t->end,   sizeof(time_t),        cap) ||
+        !GrowColumn(&t->track, sizeof(int),           cap) ||
+        !GrowColumn(&t->color, sizeof(EventColor),    cap) ||
+        !GrowColumn(&t->layer, sizeof(unsigned char), cap) ||
+        !GrowColumn(&t->name,  sizeof(TextId),        cap) ||
+        !GrowColumn(&t->desc,  sizeof(TextId),        cap)) return false;
+    t->capacity = cap;
+    return true;
+}
+
+static bool TrackerReserve(int want) { return StoreReserve(&tracker, want); }
+
+// Appends to any store without index or search bookkeeping; color is left to the caller
+static int StoreAppend(Tracker *t, const char *name, const char *desc, time_t s, time_t e)
+{
+    if (!StoreReserve(t, t->count + 1)) return -1;
+    TextId n = TextIntern(&t->text, name), d = TextIntern(&t->text, desc);
+    if (n == TEXT_NONE || d == TEXT_NONE) return -1;
+
+    int i = t->count++;
+    t->start[i] = s;
+    t->end[i]   = e;
+    t->track[i] = 0;
+    t->layer[i] = 0;
+    t->name[i]  = n;
+    t->desc[i]  = d;
+    return i;
+}
+
+// Moves event `from` into the free slot `to`
+static void TrackerMove(int from, int to)
+{
+    tracker.start[to] = tracker.start[from];
+    tracker.end[to]   = tracker.end[from];
+    tracker.track[to] = tracker.track[from];
+    tracker.color[to] = tracker.color[from];
+    tracker.layer[to] = tracker.layer[from];
+    tracker.name[to]  = tracker.name[from];
+    tracker.desc[to]  = tracker.desc[from];
+    IndexRenumber(from, to);
+    SearchChanged(to);
+}
+
+// Puts an event into slot i of the timeline file's own events (0 <= i <= editable)
+// and returns i, or -1 when out of memory. Whatever sat at i moves to the end of
+// the own events, and overlay events sit after those, so the first one moves
+// to the end of the store to make room. This is exactly what undoing a
+// TrackerRemove(i) needs.
+int TrackerInsert(int i, const char *name, const char *desc, time_t s, time_t e)
+{
+    if (i < 0 || i > tracker.editable) return -1;
+    int j = StoreAppend(&tracker, name, desc, s, e);
+    if (j < 0) return -1;
+    TextId n = tracker.name[j], d = tracker.desc[j];
+
+    if (j != tracker.editable) TrackerMove(tracker.editable, j);
+    if (i != tracker.editable) TrackerMove(i, tracker.editable);
+    tracker.start[i] = s;
+    tracker.end[i]   = e;
+    tracker.track[i] = 0;
+    tracker.color[i] = (EventColor){RandomValue(90,230), RandomValue(90,230), RandomValue(110,240), 255};
+    tracker.layer[i] = 0;
+    tracker.name[i]  = n;
+    tracker.desc[i]  = d;
+    tracker.editable++;
+    IndexInsert(i);
+    SearchChanged(i);
+    TrackerCompactText();
+    return i;
+}
+
+// Appends an event to the timeline file's own events and returns its index, or -1
+int TrackerAdd(const char *name, const char *desc, time_t s, time_t e)
+{
+    return TrackerInsert(tracker.editable, name, desc, s, e);
+}
+
+// Removes event i by moving the last event of its part of the store (the file's
+// own events or the overlays) into its slot. The file's events then keep the
+// indices they would have on their own, which is what the journal records.
+void TrackerRemove(int i)
+{
+    if (i < 0 || i >= tracker.count) return;
+    bool own = i < tracker.editable;
+    int last = own ? tracker.editable - 1 : tracker.count - 1;
+    IndexRemove(i);
+    text_generation++;
+
+    if (i != last) TrackerMove(last, i);
+    if (own && last != tracker.count - 1) TrackerMove(tracker.count - 1, last);
+    if (own) tracker.editable--;
+    tracker.count--;
+}
+
+// Replaces event i's name and description; keeps the old text on OOM. Neither
+// may point into the store's own text (copy EventName/EventDesc first).
+void TrackerSetText(int i, const char *name, const char *desc)
+{
+    if (i < 0 || i >= tracker.count) return;
+    TextId n = TextIntern(&tracker.text, name), d = TextIntern(&tracker.text, desc);
+    if (n == TEXT_NONE || d == TEXT_NONE) return;
+    if (n == tracker.name[i] && d == tracker.desc[i]) return;
+    tracker.name[i] = n;
+    tracker.desc[i] = d;
+    text_generation++;
+    SearchChanged(i);
+    TrackerCompactText();
+}
+
+void TrackerClear(void)
+{
+    TextReset(&tracker.text);
+    tracker.count = tracker.editable = 0;
+    text_generation++;
+    IndexMarkDirty();
+    SearchReset();
+}
+
+// Deep copy of the events for a background writer; view fields are not needed.
+// The text comes along as one block, without its interning table.
+static bool TrackerCopy(Tracker *dst, const Tracker *src)
+{
+    int n = src->count;
+    *dst = (Tracker){0};
+    size_t cap = n > 0 ? (size_t)n : 1;
+    dst->start = malloc(cap * sizeof(time_t));
+    dst->end   = malloc(cap * sizeof(time_t));
+    dst->track = malloc(cap * sizeof(int));
+    dst->color = malloc(cap * sizeof(EventColor));
+    dst->name  = malloc(cap * sizeof(TextId));
+    dst->desc  = malloc(cap * sizeof(TextId));
+    dst->text.data = malloc(src->text.used ? src->text.used : 1);
+    if (!dst->start || !dst->end || !dst->track || !dst->color || !dst->name || !dst->desc || !dst->text.data) return false;
+
+    memcpy(dst->start, src->start, n * sizeof(time_t));
+    memcpy(dst->end,   src->end,   n * sizeof(time_t));
+    memcpy(dst->track, src->track, n * sizeof(int));
+    memcpy(dst->color, src->color, n * sizeof(EventColor));
+    memcpy(dst->name,  src->name,  n * sizeof(TextId));
+    memcpy(dst->desc,  src->desc,  n * sizeof(TextId));
+    memcpy(dst->text.data, src->text.data, src->text.used);
+    dst->text.used = dst->text.capacity = src->text.used;
+    dst->count = dst->editable = n;
+    return true;
+}
+
+static void TrackerFreeCopy(Tracker *t)
+{
+    free(t->start); free(t->end); free(t->track); free(t->color); free(t->layer); free(t->name); free(t->desc);
+    TextFree(&t->text);
+    *t = (Tracker){0};
+}
+
+// Moves the strings store t still uses into a fresh arena, dropping the rest
+static bool StoreCompactText(Tracker *t)
+{
+    TextArena fresh = {0};
+    TextId *ids = malloc((t->count > 0 ? (size_t)t->count : 1) * 2 * sizeof(TextId));
+    bool ok = ids != NULL;
+    for (int i = 0; ok && i < t->count; i++) {
+        ids[2*i]   = TextIntern(&fresh, t->text.data + t->name[i]);
+        ids[2*i+1] = TextIntern(&fresh, t->text.data + t->desc[i]);
+        ok = ids[2*i] != TEXT_NONE && ids[2*i+1] != TEXT_NONE;
+    }
+    if (!ok) { free(ids); TextFree(&fresh); return false; }
+
+    for (int i = 0; i < t->count; i++) { t->name[i] = ids[2*i]; t->desc[i] = ids[2*i+1]; }
+    free(ids);
+    TextFree(&t->text);
+    t->text = fresh;
+    t->text.live = fresh.used;
+    if (t == &tracker) text_generation++;
+    return true;
+}
+
+// Called after edits that add text: compacts once garbage outweighs what's live
+static void TrackerCompactText(void)
+{
+    if (tracker.text.used > 2 * (size_t)tracker.text.live + TEXT_SLACK) StoreCompactText(&tracker);
+}
+
+double DurationYears(int i)
+{
+    return difftime(tracker.end[i], tracker.start[i]) / (365.25 * 86400.0);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Level of detail – per track, counts and covered seconds of the short events in
+// power-of-two time buckets (2^LOD_BASE_SHIFT seconds at level 0, doubling per
+// level). An event lives in every level whose bucket is longer than it, in the
+// one or two buckets it touches. When zoomed out, DrawEvents picks the level
+// whose buckets are about a pixel wide, draws those as heat strips and asks the
+// index only for events at least one bucket long, so the work per frame follows
+// the screen size instead of how many events are in view.
+//
+// The cells sit in one hash table keyed by (level, track, bucket). lod.s/e/track
+// remember what each event was added with, so LodSync can take it back out after
+// the columns changed; LayoutRange calls it for every event it re-stacks.
+//
+// A full index build or a snapshot load doesn't fill the pyramid: the first
+// LodLevelFor that picks a level afterwards does, so startup only pays for it
+// once the view is zoomed out far enough to need it.
+// ─────────────────────────────────────────────────────────────────────────────
+#define LOD_EMPTY UINT64_MAX
+
+typedef struct {
+    LodCell *cells;
+    int      used, capacity;   // capacity is a power of two
+    time_t  *s, *e;            // per event, as last added (track -1: not added)
+    int     *track;
+    int      events;           // size of the per-event columns
+    bool     ok;               // false after an allocation failure; IndexBuild retries
+    bool     pending;          // filled from the store by the next LodLevelFor that needs it
+    bool     off;              // never built: nothing gets drawn (see PeekTimeline)
+} LodPyramid;
+
+static LodPyramid lod = {0};
+
+uint64_t LodKey(int level, int track, int64_t bucket)
+{
+    return ((uint64_t)level << 56) | ((uint64_t)(track & 0xFFFFFF) << 32) | (uint32_t)bucket;
+}
+
+static size_t LodSlot(uint64_t key, int capacity)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key & (capacity - 1);
+}
+
+// Rehashes into `capacity` slots, dropping cells that went back to zero
+static bool LodRehash(int capacity)
+{
+    LodCell *cells = malloc(capacity * sizeof(LodCell));
+    if (!cells) return false;
+    for (int k = 0; k < capacity; k++) cells[k].key = LOD_EMPTY;
+
+    int used = 0;
+    for (int k = 0; k < lod.capacity; k++) {
+        LodCell c = lod.cells[k];
+        if (c.key == LOD_EMPTY || (c.count == 0 && c.covered == 0)) continue;
+        size_t slot = LodSlot(c.key, capacity);
+        while (cells[slot].key != LOD_EMPTY) slot = (slot + 1) & (capacity - 1);
+        cells[slot] = c;
+        used++;
+    }
+    free(lod.cells);
+    lod.cells = cells;
+    lod.capacity = capacity;
+    lod.used = used;
+    return true;
+}
+
+const LodCell *LodFind(uint64_t key)
+{
+    if (!lod.capacity) return NULL;
+    for (size_t slot = LodSlot(key, lod.capacity); lod.cells[slot].key != LOD_EMPTY; slot = (slot + 1) & (lod.capacity - 1))
+        if (lod.cells[slot].key == key) return &lod.cells[slot];
+    return NULL;
+}
+
+static LodCell *LodCellFor(uint64_t key)
+{
+    if ((lod.used + 1) * 4 > lod.capacity * 3 && !LodRehash(lod.capacity ? lod.capacity * 2 : 4096)) return NULL;
+    size_t slot = LodSlot(key, lod.capacity);
+    while (lod.cells[slot].key != LOD_EMPTY && lod.cells[slot].key != key) slot = (slot + 1) & (lod.capacity - 1);
+    if (lod.cells[slot].key == LOD_EMPTY) {
+        lod.cells[slot] = (LodCell){ key, 0, 0 };
+        lod.used++;
+    }
+    return &lod.cells[slot];
+}
+
+time_t LodBucketSecs(int level) { return (time_t)1 << (LOD_BASE_SHIFT + level); }
+
+// Adds (sign 1) or takes back (sign -1) one event's share of every level it is short at
+static void LodApply(time_t s, time_t e, int track, int sign)
+{
+    if (e < s) e = s;
+    for (int level = 0; level < LOD_LEVELS && lod.ok; level++) {
+        int shift = LOD_BASE_SHIFT + level;
+        time_t size = LodBucketSecs(level);
+        if (e - s >= size) continue;
+
+        // Floor division by the bucket size, also for times before 1970
+        int64_t b0 = s >> shift, b1 = (e > s ? e - 1 : s) >> shift;
+        for (int64_t b = b0; b <= b1; b++) {
+            time_t lo = s > b * size ? s : b * size;
+            time_t hi = e < (b + 1) * size ? e : (b + 1) * size;
+            LodCell *c = LodCellFor(LodKey(level, track, b));
+            if (!c) { lod.ok = false; return; }
+            c->covered += (uint32_t)(sign * (hi - lo));
+            if (b == b0) c->count += (uint32_t)sign;
+
+            if (sign > 0) {
+                // Tells the drawing how many rows this bucket can have data in
+                LodCell *h = LodCellFor(LodKey(level, LOD_HEADER, b));
+                if (!h) { lod.ok = false; return; }
+                if (h->count < (uint32_t)track + 1) h->count = (uint32_t)track + 1;
+            }
+        }
+    }
+}
+
+// Forgets everything; events come back through LodSync
+static void LodReset(int events)
+{
+    lod.ok = !lod.off;
+    if (lod.off) return;
+    if (events > lod.events) {
+        int cap = lod.events ? lod.events : 256;
+        while (cap < events) cap *= 2;
+        if (!GrowColumn(&lod.s, sizeof(time_t), cap) || !GrowColumn(&lod.e, sizeof(time_t), cap) ||
+            !GrowColumn(&lod.track, sizeof(int), cap)) { lod.ok = false; return; }
+        lod.events = cap;
+    }
+    for (int i = 0; i < lod.events; i++) lod.track[i] = -1;
+    for (int k = 0; k < lod.capacity; k++) lod.cells[k].key = LOD_EMPTY;
+    lod.used = 0;
+}
+
+// Drops the pyramid until LodLevelFor needs it again; edits until then don't touch it
+static void LodDefer(void)
+{
+    lod.ok = false;
+    lod.pending = !lod.off;
+}
+
+// Makes room in the per-event columns for event i
+static bool LodReserve(int i)
+{
+    if (i < lod.events) return true;
+    int cap = lod.events ? lod.events * 2 : 256;
+    while (cap <= i) cap *= 2;
+    if (!GrowColumn(&lod.s, sizeof(time_t), cap) || !GrowColumn(&lod.e, sizeof(time_t), cap) ||
+        !GrowColumn(&lod.track, sizeof(int), cap)) { lod.ok = false; return false; }
+    for (int k = lod.events; k < cap; k++) lod.track[k] = -1;
+    lod.events = cap;
+    return true;
+}
+
+// Event i's start, end or track may have changed since it was last added.
+// Track -1 (a hidden layer) takes it out.
+static void LodSync(int i)
+{
+    if (!lod.ok || !LodReserve(i)) return;
+    time_t s = tracker.start[i], e = tracker.end[i];
+    int track = tracker.track[i];
+    if (lod.track[i] == track && lod.s[i] == s && lod.e[i] == e) return;
+
+    if (lod.track[i] >= 0) LodApply(lod.s[i], lod.e[i], lod.track[i], -1);
+    if (track >= 0) LodApply(s, e, track, 1);
+    lod.s[i] = s;
+    lod.e[i] = e;
+    lod.track[i] = track;
+}
+
+// Event i is leaving the store
+static void LodDrop(int i)
+{
+    if (!lod.ok || i >= lod.events || lod.track[i] < 0) return;
+    LodApply(lod.s[i], lod.e[i], lod.track[i], -1);
+    lod.track[i] = -1;
+}
+
+// The store moved event `from` into slot `to`
+static void LodRenumber(int from, int to)
+{
+    if (!lod.ok || from >= lod.events || !LodReserve(to)) return;
+    lod.s[to] = lod.s[from];
+    lod.e[to] = lod.e[from];
+    lod.track[to] = lod.track[from];
+    lod.track[from] = -1;
+}
+
+// Level whose buckets are 1-2 px at this zoom, or -1 to draw every event as is.
+// Fills a deferred pyramid first, from freshly stacked tracks.
+int LodLevelFor(double secs_per_px)
+{
+    if (secs_per_px <= 0.0) return -1;
+    int level = (int)ceil(log2(secs_per_px)) - LOD_BASE_SHIFT;
+    if (level < 0) return -1;
+    if (lod.pending) {
+        IndexEnsure();
+        lod.pending = false;
+        LodReset(tracker.count);
+        for (int i = 0; i < tracker.count && lod.ok; i++) LodSync(i);
+    }
+    if (!lod.ok) return -1;
+    return level < LOD_LEVELS ? level : LOD_LEVELS - 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Interval index – events sorted by start, read as an implicit binary tree:
+// the node at sorted position p on level k spans p ± (2^k - 1), and max_end[p]
+// is the largest end inside that span. An overlap query walks the tree and
+// prunes every subtree that ends before the query, so it costs O(log n + k).
+//
+// The same order drives the track layout. run_end[p] is the largest end among
+// the shown events in order[0..p], so a position whose start is >= run_end[p-1] opens a new cluster
+// of overlapping events that stacks independently of everything before it.
+// Edits re-sort the one event that changed and re-stack only its clusters.
+// ─────────────────────────────────────────────────────────────────────────────
+typedef struct { int k, p; bool left_done; } IndexFrame;
+
+IntervalIndex ev_index = { .dirty = true };
+
+void IndexMarkDirty(void) { ev_index.dirty = true; }
+
+static bool EventBefore(int i, int j)
+{
+    if (tracker.start[i] != tracker.start[j]) return tracker.start[i] < tracker.start[j];
+    return i < j;
+}
+
+static int CompareByStart(const void *a, const void *b)
+{
+    int i = *(const int*)a, j = *(const int*)b;
+    return EventBefore(i, j) ? -1 : EventBefore(j, i) ? 1 : 0;
+}
+
+static bool IndexReserve(int n)
+{
+    if (n <= ev_index.capacity) return true;
+    int cap = ev_index.capacity ? ev_index.capacity : 256;
+    while (cap < n) cap *= 2;
+    if (!GrowColumn(&ev_index.order,   sizeof(int),    cap) ||
+        !GrowColumn(&ev_index.pos,     sizeof(int),    cap) ||
+        !GrowColumn(&ev_index.max_end, sizeof(time_t), cap) ||
+        !GrowColumn(&ev_index.max_len, sizeof(time_t), cap) ||
+        !GrowColumn(&ev_index.run_end, sizeof(time_t), cap) ||
+        !GrowColumn(&ev_index.hits,    sizeof(int),    cap)) return false;
+    ev_index.capacity = cap;
+    return true;
+}
+
+// Recomputes max_end and max_len for every tree node whose span touches positions [lo, hi].
+// Leaves (even positions) hold their own end; each level up folds in both children.
+// A right child past the end of the array takes the max of the last real subtree.
+static void IndexRefresh(int lo, int hi)
+{
+    int n = ev_index.count;
+    if (n == 0) { ev_index.max_level = 0; return; }
+    if (lo < 0) lo = 0;
+    if (hi > n - 1) hi = n - 1;
+
+    const int *order = ev_index.order;
+    time_t *mx = ev_index.max_end, *ml = ev_index.max_len;
+    for (int p = lo & ~1; p <= hi; p += 2) {
+        mx[p] = tracker.end[order[p]];
+        ml[p] = tracker.end[order[p]] - tracker.start[order[p]];
+    }
+
+    int last_p = (n - 1) & ~1, k;
+    time_t last = mx[last_p], last_len = ml[last_p];
+    for (k = 1; (1 << k) <= n; k++) {
+        int x = 1 << (k - 1), span = (x << 1) - 1, step = x << 2;
+        int p = span;
+        if (lo - span > p) p += (lo - span - p + step - 1) / step * step;
+        for (; p < n && p - span <= hi; p += step) {
+            time_t e  = tracker.end[order[p]];
+            time_t el = mx[p - x];
+            time_t er = (p + x < n) ? mx[p + x] : last;
+            if (el > e) e = el;
+            if (er > e) e = er;
+            mx[p] = e;
+
+            time_t len = tracker.end[order[p]] - tracker.start[order[p]];
+            time_t ll  = ml[p - x];
+            time_t lr  = (p + x < n) ? ml[p + x] : last_len;
+            if (ll > len) len = ll;
+            if (lr > len) len = lr;
+            ml[p] = len;
+        }
+        last_p = ((last_p >> k) & 1) ? last_p - x : last_p + x;
+        if (last_p < n && mx[last_p] > last) last = mx[last_p];
+        if (last_p < n && ml[last_p] > last_len) last_len = ml[last_p];
+    }
+    ev_index.max_level = k - 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Track scheduler – interval partitioning over events fed in start order.
+// Busy tracks sit in a min-heap keyed by the time they free up, released tracks
+// in a min-heap keyed by track number, so every event lands on the lowest free
+// track (same result as a first-fit scan) and the layout uses as few tracks as
+// the deepest overlap needs, in O(n log n) and without a cap.
+// ─────────────────────────────────────────────────────────────────────────────
+typedef struct { time_t end; int track; } BusyTrack;
+
+typedef struct {
+    BusyTrack *busy;  int busy_count, busy_cap;
+    int       *idle;  int idle_count, idle_cap;
+    int        track_count;
+} TrackScheduler;
+
+static TrackScheduler scheduler;
+
+static void SchedulerReset(TrackScheduler *ts)
+{
+    ts->busy_count = ts->idle_count = ts->track_count = 0;
+}
+
+static void BusyPush(TrackScheduler *ts, BusyTrack b)
+{
+    int k = ts->busy_count++;
+    while (k > 0) {
+        int parent = (k - 1) / 2;
+        if (ts->busy[parent].end <= b.end) break;
+        ts->busy[k] = ts->busy[parent];
+        k = parent;
+    }
+    ts->busy[k] = b;
+}
+
+static BusyTrack BusyPop(TrackScheduler *ts)
+{
+    BusyTrack top = ts->busy[0], moved = ts->busy[--ts->busy_count];
+    int k = 0, n = ts->busy_count;
+    for (;;) {
+        int c = 2 * k + 1;
+        if (c >= n) break;
+        if (c + 1 < n && ts->busy[c+1].end < ts->busy[c].end) c++;
+        if (moved.end <= ts->busy[c].end) break;
+        ts->busy[k] = ts->busy[c];
+        k = c;
+    }
+    if (n) ts->busy[k] = moved;
+    return top;
+}
+
+static void IdlePush(TrackScheduler *ts, int track)
+{
+    int k = ts->idle_count++;
+    while (k > 0) {
+        int parent = (k - 1) / 2;
+        if (ts->idle[parent] <= track) break;
+        ts->idle[k] = ts->idle[parent];
+        k = parent;
+    }
+    ts->idle[k] = track;
+}
+
+static int IdlePop(TrackScheduler *ts)
+{
+    int top = ts->idle[0], moved = ts->idle[--ts->idle_count];
+    int k = 0, n = ts->idle_count;
+    for (;;) {
+        int c = 2 * k + 1;
+        if (c >= n) break;
+        if (c + 1 < n && ts->idle[c+1] < ts->idle[c]) c++;
+        if (moved <= ts->idle[c]) break;
+        ts->idle[k] = ts->idle[c];
+        k = c;
+    }
+    if (n) ts->idle[k] = moved;
+    return top;
+}
+
+// Picks the track for the next event in start order. Returns 0 if the heaps
+// cannot grow, which only stacks that bar on top of another one.
+static int SchedulerAssign(TrackScheduler *ts, time_t start, time_t end)
+{
+    while (ts->busy_count && ts->busy[0].end <= start) {
+        if (ts->idle_count == ts->idle_cap) {
+            int cap = ts->idle_cap ? ts->idle_cap * 2 : 64;
+            if (!GrowColumn(&ts->idle, sizeof(int), cap)) return 0;
+            ts->idle_cap = cap;
+        }
+        IdlePush(ts, BusyPop(ts).track);
+    }
+
+    if (ts->busy_count == ts->busy_cap) {
+        int cap = ts->busy_cap ? ts->busy_cap * 2 : 64;
+        if (!GrowColumn(&ts->busy, sizeof(BusyTrack), cap)) return 0;
+        ts->busy_cap = cap;
+    }
+    int track = ts->idle_count ? IdlePop(ts) : ts->track_count++;
+    BusyPush(ts, (BusyTrack){ end, track });
+    return track;
+}
+
+// Re-stacks the clusters around sorted positions [lo, hi]. Positions below lo
+// must be unchanged; run_end from hi on still holds the values from before the
+// edit, which is what tells us where the old and new layouts agree again.
+static void LayoutRange(int lo, int hi)
+{
+    const int n = ev_index.count;
+    const int *order = ev_index.order;
+    time_t *run = ev_index.run_end;
+    if (lo < 0) lo = 0;
+    if (lo >= n) return;
+
+    // Back up to the first event of the cluster that contains lo
+    int q = lo;
+    while (q > 0 && tracker.start[order[q]] < run[q-1]) q--;
+
+    SchedulerReset(&scheduler);
+    time_t prev = q ? run[q-1] : TIME_MIN;
+    time_t old_prev = prev;
+
+    for (; q < n; q++) {
+        int i = order[q];
+        // Past the edit, a cluster boundary in both the old and the new layout
+        // means everything from here on stacks exactly as it did before
+        if (q > hi && tracker.start[i] >= prev && tracker.start[i] >= old_prev) break;
+
+        // Hidden layers get no track and don't hold a cluster open
+        bool shown = !layers[tracker.layer[i]].hidden;
+        tracker.track[i] = shown ? SchedulerAssign(&scheduler, tracker.start[i], tracker.end[i]) : -1;
+        LodSync(i);
+
+        old_prev = run[q];
+        if (shown && tracker.end[i] > prev) prev = tracker.end[i];
+        run[q] = prev;
+    }
+}
+
+static void IndexBuild(void)
+{
+    int n = tracker.count;
+    if (!IndexReserve(n)) { ev_index.count = 0; return; }
+
+    for (int p = 0; p < n; p++) ev_index.order[p] = p;
+    if (n > 1) qsort(ev_index.order, n, sizeof(int), CompareByStart);
+    for (int p = 0; p < n; p++) ev_index.pos[ev_index.order[p]] = p;
+
+    ev_index.count = n;
+    IndexRefresh(0, n - 1);
+    LodDefer();
+    LayoutRange(0, n - 1);
+    ev_index.dirty = false;
+}
+
+// Takes over a sorted order and track layout saved earlier (see LoadSnapshot)
+// instead of sorting and stacking again. Falls back to IndexBuild if the order
+// is not a sorted permutation of the current events.
+static void IndexAdopt(const int32_t *order)
+{
+    int n = tracker.count;
+    if (!IndexReserve(n)) { ev_index.count = 0; return; }
+
+    bool valid = true;
+    for (int i = 0; i < n; i++) ev_index.pos[i] = -1;
+    for (int p = 0; p < n && valid; p++) {
+        int i = order[p];
+        valid = i >= 0 && i < n && ev_index.pos[i] < 0 && tracker.track[i] >= 0 &&
+                (p == 0 || EventBefore(order[p-1], i));
+        if (valid) { ev_index.order[p] = i; ev_index.pos[i] = p; }
+    }
+    if (!valid) { IndexBuild(); return; }
+
+    time_t run = TIME_MIN;
+    for (int p = 0; p < n; p++) {
+        if (tracker.end[order[p]] > run) run = tracker.end[order[p]];
+        ev_index.run_end[p] = run;
+    }
+    ev_index.count = n;
+    IndexRefresh(0, n - 1);
+    LodDefer();
+    ev_index.dirty = false;
+}
+
+void IndexEnsure(void)
+{
+    if (ev_index.dirty || ev_index.count != tracker.count) IndexBuild();
+}
+
+// Event i was just appended to the store
+static void IndexInsert(int i)
+{
+    if (ev_index.dirty) return;
+    int n = ev_index.count;
+    if (!IndexReserve(n + 1)) { ev_index.dirty = true; return; }
+
+    int *order = ev_index.order;
+    int lo = 0, hi = n;
+    while (lo < hi) { int mid = (lo + hi) / 2; if (EventBefore(order[mid], i)) lo = mid + 1; else hi = mid; }
+
+    memmove(&order[lo+1], &order[lo], (n - lo) * sizeof(int));
+    memmove(&ev_index.run_end[lo+1], &ev_index.run_end[lo], (n - lo) * sizeof(time_t));
+    order[lo] = i;
+    ev_index.run_end[lo] = lo ? ev_index.run_end[lo-1] : TIME_MIN;
+    ev_index.count = n + 1;
+    for (int p = lo; p <= n; p++) ev_index.pos[order[p]] = p;
+
+    IndexRefresh(lo, n);
+    LayoutRange(lo, lo);
+}
+
+// Event i is about to leave the store (its columns are still intact)
+static void IndexRemove(int i)
+{
+    if (ev_index.dirty) return;
+    int n = ev_index.count, p = ev_index.pos[i];
+    int *order = ev_index.order;
+    LodDrop(i);
+
+    memmove(&order[p], &order[p+1], (n - p - 1) * sizeof(int));
+    memmove(&ev_index.run_end[p], &ev_index.run_end[p+1], (n - p - 1) * sizeof(time_t));
+    ev_index.count = --n;
+    for (int q = p; q < n; q++) ev_index.pos[order[q]] = q;
+
+    IndexRefresh(p, n - 1);
+    LayoutRange(p, p);
+}
+
+// Start and/or end of event i changed: slide it to its new sorted position
+void IndexMoved(int i)
+{
+    if (ev_index.dirty) return;
+    int n = ev_index.count, p = ev_index.pos[i], b = p;
+    int *order = ev_index.order;
+
+    if (p > 0 && EventBefore(i, order[p-1])) {
+        int lo = 0, hi = p;
+        while (lo < hi) { int mid = (lo + hi) / 2; if (EventBefore(order[mid], i)) lo = mid + 1; else hi = mid; }
+        b = lo;
+        memmove(&order[b+1], &order[b], (p - b) * sizeof(int));
+    } else if (p < n - 1 && EventBefore(order[p+1], i)) {
+        int lo = p + 1, hi = n;
+        while (lo < hi) { int mid = (lo + hi) / 2; if (EventBefore(order[mid], i)) lo = mid + 1; else hi = mid; }
+        b = lo - 1;
+        memmove(&order[p], &order[p+1], (b - p) * sizeof(int));
+    }
+    order[b] = i;
+
+    int lo = p < b ? p : b, hi = p < b ? b : p;
+    for (int q = lo; q <= hi; q++) ev_index.pos[order[q]] = q;
+    IndexRefresh(lo, hi);
+    LayoutRange(lo, hi);
+}
+
+// The store moved event `from` into slot `to` (swap-remove, or making room for
+// an insert, where `to` can be the slot just appended)
+static void IndexRenumber(int from, int to)
+{
+    if (ev_index.dirty || from == to) return;
+    if (!IndexReserve(to + 1)) { ev_index.dirty = true; return; }
+    int p = ev_index.pos[from], n = ev_index.count;
+    LodRenumber(from, to);
+    ev_index.order[p] = to;
+    ev_index.pos[to] = p;
+
+    // Ties on start are ordered by index, so the new number may need a nudge
+    if ((p > 0 && EventBefore(to, ev_index.order[p-1])) ||
+        (p < n - 1 && EventBefore(ev_index.order[p+1], to))) IndexMoved(to);
+}
+
+// Collects every shown event with start <= to && end >= from and end - start >= min_len
+// into ev_index.hits, in start order. Returns the number of hits. max_len lets
+// a long-events-only query skip subtrees of short ones without visiting them.
+int IndexQuery(time_t from, time_t to, time_t min_len)
+{
+    IndexEnsure();
+    int n = ev_index.count, found = 0;
+    if (n == 0) return 0;
+
+    const int    *order = ev_index.order;
+    const time_t *mx    = ev_index.max_end;
+    const time_t *ml    = ev_index.max_len;
+    const time_t *start = tracker.start, *end = tracker.end;
+    const int    *track = tracker.track;   // -1: hidden layer
+    IndexFrame stack[64];
+    int top = 0;
+    stack[top++] = (IndexFrame){ ev_index.max_level, (1 << ev_index.max_level) - 1, 0 };
+
+    while (top) {
+        IndexFrame z = stack[--top];
+        if (z.k <= 3) {
+            // Small subtree: a linear scan beats more stack traffic
+            int p0 = z.p >> z.k << z.k, p1 = p0 + (1 << (z.k + 1)) - 1;
+            if (p1 > n) p1 = n;
+            for (int p = p0; p < p1 && start[order[p]] <= to; p++)
+                if (end[order[p]] >= from && end[order[p]] - start[order[p]] >= min_len && track[order[p]] >= 0)
+                    ev_index.hits[found++] = order[p];
+        } else if (!z.left_done) {
+            int left = z.p - (1 << (z.k - 1));
+            stack[top++] = (IndexFrame){ z.k, z.p, 1 };
+            if (left >= n || (mx[left] >= from && ml[left] >= min_len))
+                stack[top++] = (IndexFrame){ z.k - 1, left, 0 };
+        } else if (z.p < n && start[order[z.p]] <= to) {
+            int i = order[z.p], right = z.p + (1 << (z.k - 1));
+            if (end[i] >= from && end[i] - start[i] >= min_len && track[i] >= 0) ev_index.hits[found++] = i;
+            if (right >= n || (mx[right] >= from && ml[right] >= min_len))
+                stack[top++] = (IndexFrame){ z.k - 1, right, 0 };
+        }
+    }
+    return found;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Hit-testing – the same bar geometry DrawEvents draws: at least 2 px wide,
+// clipped to the view, 16 px tall around its track line
+// ─────────────────────────────────────────────────────────────────────────────
+// First event in start order whose bar contains (x, y), or -1
+int EventPick(const TimelineView *v, float x, float y)
+{
+    double secs_per_pixel = (365.25 * 86400.0) / v->pixels_per_year;
+    time_t cursor_time = v->view_start + (time_t)(x * secs_per_pixel);
+    int candidates = IndexQuery(cursor_time - (time_t)(3.0 * secs_per_pixel) - 1, cursor_time + 1, 0);
+
+    for (int h = 0; h < candidates; h++) {
+        int i = ev_index.hits[h];
+        double secs_from_view = difftime(tracker.start[i], v->view_start);
+        float x_start = (float)(secs_from_view * v->pixels_per_year / (365.25 * 86400.0));
+        float duration_px = DurationYears(i) * v->pixels_per_year;
+        if (duration_px < 2.0f) duration_px = 2.0f;
+
+        float draw_x1 = fmaxf(x_start, 0.0f);
+        float draw_len = fminf(x_start + duration_px, v->width) - draw_x1;
+        if (draw_len <= 0.0f) continue;
+
+        float bar_y = v->rows_y + tracker.track[i] * v->row_spacing - 7;
+        if (x >= draw_x1 && x < draw_x1 + draw_len && y >= bar_y && y < bar_y + 16) return i;
+    }
+    return -1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Full-text search – trigram index over names and descriptions, ASCII letters
+// case-folded. Every trigram has a posting list of event indices; a query walks
+// the shortest list among its trigrams, keeps the candidates that also sit in
+// the next few shortest, and checks those against the text. Queries shorter
+// than a trigram scan the store in start order for at most SEARCH_SCAN_SECS
+// (see SearchPartial); one or two bytes rarely need long before the screen is full.
+//
+// Results are the earliest matches by start: a short candidate list is checked
+// in full and the first max_hits kept, a long one is walked in start order
+// through the interval index until max_hits are found.
+//
+// Since candidates are always checked, postings are never taken out: edits and
+// swap-removes only append, and stale entries simply fail the check. Once the
+// lists have doubled since the last build they get rebuilt from scratch.
+// ─────────────────────────────────────────────────────────────────────────────
+#define SEARCH_LISTS     4        // posting lists a query intersects at most
+#define SEARCH_COLLECT   1024     // candidates checked in full; more are walked in start order
+#define SEARCH_SCAN_SECS 0.0005   // how long a short query may scan
+
+typedef struct {
+    uint32_t *ids;
+    int count, capacity;
+} Posting;
+
+static struct {
+    uint32_t *keys;       // trigram + 1, 0 = empty slot
+    Posting  *lists;      // parallel to keys
+    int       capacity, used;
+    uint32_t *stamp;      // per event, see SearchQuery
+    uint32_t  gen;
+    int       stamp_capacity;
+    size_t    postings, built_postings;
+    bool      dirty;      // the next SearchEnsure rebuilds everything
+    bool      partial;    // the last query's scan ran out of budget
+} search = {.dirty = true};
+
+static inline unsigned char Fold(unsigned char c) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+
+static inline uint32_t Trigram(const char *s)
+{
+    return (uint32_t)Fold(s[0]) << 16 | (uint32_t)Fold(s[1]) << 8 | Fold(s[2]);
+}
+
+static inline uint32_t TrigramHash(uint32_t t)
+{
+    uint32_t h = t * 0x9E3779B1u;
+    return h ^ (h >> 15);
+}
+
+static bool SearchGrow(void)
+{
+    int cap = search.capacity ? search.capacity * 2 : 4096;
+    uint32_t *keys = calloc(cap, sizeof(uint32_t));
+    Posting *lists = calloc(cap, sizeof(Posting));
+    if (!keys || !lists) { free(keys); free(lists); return false; }
+
+    for (int k = 0; k < search.capacity; k++) {
+        if (!search.keys[k]) continue;
+        uint32_t s = TrigramHash(search.keys[k] - 1) & (cap - 1);
+        while (keys[s]) s = (s + 1) & (cap - 1);
+        keys[s] = search.keys[k];
+        lists[s] = search.lists[k];
+    }
+    free(search.keys);
+    free(search.lists);
+    search.keys = keys;
+    search.lists = lists;
+    search.capacity = cap;
+    return true;
+}
+
+static Posting *SearchList(uint32_t t, bool create)
+{
+    if (create && (search.used + 1) * 4 > search.capacity * 3 && !SearchGrow()) return NULL;
+    if (search.capacity == 0) return NULL;
+
+    uint32_t s = TrigramHash(t) & (search.capacity - 1);
+    while (search.keys[s]) {
+        if (search.keys[s] == t + 1) return &search.lists[s];
+        s = (s + 1) & (search.capacity - 1);
+    }
+    if (!create) return NULL;
+    search.keys[s] = t + 1;
+    search.used++;
+    return &search.lists[s];
+}
+
+static void SearchAddText(int i, const char *s)
+{
+    size_t n = strlen(s);
+    for (size_t p = 0; p + 3 <= n; p++) {
+        uint32_t t = Trigram(s + p);
+
+        // Re-indexing the same event (typing into its name) mostly lands here
+        Posting *l = SearchList(t, true);
+        if (!l || (l->count && l->ids[l->count - 1] == (uint32_t)i)) continue;
+        if (l->count == l->capacity) {
+            int cap = l->capacity ? l->capacity * 2 : 4;
+            if (!GrowColumn(&l->ids, sizeof(uint32_t), cap)) continue;
+            l->capacity = cap;
+        }
+        l->ids[l->count++] = (uint32_t)i;
+        search.postings++;
+    }
+}
+
+static void SearchIndexEvent(int i)
+{
+    if (i >= search.stamp_capacity) {
+        int old = search.stamp_capacity;
+        if (!GrowColumn(&search.stamp, sizeof(uint32_t), tracker.capacity)) { search.dirty = true; return; }
+        memset(search.stamp + old, 0, (tracker.capacity - old) * sizeof(uint32_t));
+        search.stamp_capacity = tracker.capacity;
+    }
+    SearchAddText(i, EventName(i));
+    SearchAddText(i, EventDesc(i));
+}
+
+// Event i has new text: it was added, edited, or moved into slot i by a swap-remove
+static void SearchChanged(int i)
+{
+    if (search.dirty) return;
+    SearchIndexEvent(i);
+    if (search.postings > 2 * search.built_postings + 65536) search.dirty = true;
+}
+
+static void SearchReset(void)
+{
+    search.dirty = true;
+}
+
+void SearchEnsure(void)
+{
+    if (!search.dirty) return;
+    for (int k = 0; k < search.capacity; k++) search.lists[k].count = 0;
+    search.postings = 0;
+    search.dirty = false;
+    for (int i = 0; i < tracker.count && !search.dirty; i++) SearchIndexEvent(i);
+    search.built_postings = search.postings;
+}
+
+// needle is already folded
+static bool ContainsFolded(const char *hay, const char *needle, size_t n)
+{
+    for (; *hay; hay++) {
+        size_t k = 0;
+        while (k < n && hay[k] && Fold(hay[k]) == (unsigned char)needle[k]) k++;
+        if (k == n) return true;
+    }
+    return false;
+}
+
+static bool SearchMatch(int i, const char *q, size_t n)
+{
+    if (layers[tracker.layer[i]].hidden) return false;
+    return ContainsFolded(EventName(i), q, n) || ContainsFolded(EventDesc(i), q, n);
+}
+
+// Keeps hits[0..*found) the earliest max_hits seen so far, by (start, index)
+static void SearchKeep(int *hits, int *found, int max_hits, int i)
+{
+    int b = *found;
+    if (b == max_hits) {
+        if (!EventBefore(i, hits[b - 1])) return;
+        b--;
+    } else (*found)++;
+    for (; b > 0 && EventBefore(i, hits[b - 1]); b--) hits[b] = hits[b - 1];
+    hits[b] = i;
+}
+
+// Events in start order until max_hits match or `secs` (0: no limit) are up
+static int SearchScan(const char *q, size_t n, int *hits, int max_hits, double secs)
+{
+    IndexEnsure();
+    double deadline = NowSeconds() + secs;
+    int found = 0, p = 0;
+    for (; p < ev_index.count && found < max_hits; p++) {
+        if (secs > 0 && (p & 1023) == 1023 && NowSeconds() > deadline) break;
+        if (SearchMatch(ev_index.order[p], q, n)) hits[found++] = ev_index.order[p];
+    }
+    search.partial = found < max_hits && p < ev_index.count;
+    return found;
+}
+
+// Up to max_hits events whose name or description contains query: the earliest
+// by start, in start order. Queries under three bytes only scan for
+// SEARCH_SCAN_SECS; SearchPartial says whether there could be more.
+int SearchQuery(const char *query, int *hits, int max_hits)
+{
+    char q[1024];
+    size_t n = 0;
+    for (; query[n] && n < sizeof(q) - 1; n++) q[n] = (char)Fold(query[n]);
+    q[n] = '\0';
+    search.partial = false;
+    if (n == 0 || max_hits <= 0) return 0;
+
+    SearchEnsure();
+    if (search.dirty) return SearchScan(q, n, hits, max_hits, 0);   // out of memory for the index
+    if (n < 3) return SearchScan(q, n, hits, max_hits, SEARCH_SCAN_SECS);
+
+    // Distinct lists of the query's trigrams, shortest first
+    const Posting *lists[SEARCH_LISTS];
+    int m = 0;
+    for (size_t p = 0; p + 3 <= n; p++) {
+        const Posting *l = SearchList(Trigram(q + p), false);
+        if (!l || l->count == 0) return 0;
+        bool dup = false;
+        for (int k = 0; k < m && !dup; k++) dup = lists[k] == l;
+        if (dup) continue;
+        if (m == SEARCH_LISTS) {
+            if (l->count >= lists[m - 1]->count) continue;
+            m--;
+        }
+        int k = m++;
+        for (; k > 0 && lists[k - 1]->count > l->count; k--) lists[k] = lists[k - 1];
+        lists[k] = l;
+    }
+    // Stamping another list only pays while it isn't much longer than the first
+    while (m > 1 && lists[m - 1]->count > 8 * lists[0]->count) m--;
+
+    if (search.gen >= UINT32_MAX - SEARCH_LISTS - 3) {
+        memset(search.stamp, 0, search.stamp_capacity * sizeof(uint32_t));
+        search.gen = 0;
+    }
+    // Event i survives list j if stamp[i] == gen + j afterwards; gen + m marks a
+    // candidate (in every list) and gen + m + 1 one already checked
+    uint32_t gen = search.gen, cand = gen + m;
+    search.gen += m + 2;
+    for (int j = 1; j < m; j++)
+        for (int k = 0; k < lists[j]->count; k++) {
+            uint32_t i = lists[j]->ids[k];
+            if (j == 1 || search.stamp[i] == gen + j - 1) search.stamp[i] = gen + j;
+        }
+
+    const Posting *best = lists[0];
+    int candidates = 0;
+    for (int k = 0; k < best->count; k++) {
+        uint32_t i = best->ids[k];
+        if (i >= (uint32_t)tracker.count || search.stamp[i] == cand) continue;
+        if (m > 1 && search.stamp[i] != cand - 1) continue;
+        search.stamp[i] = cand;
+        candidates++;
+    }
+
+    int found = 0;
+    if (candidates > SEARCH_COLLECT) {
+        // Plenty of them: the first max_hits that match in start order
+        IndexEnsure();
+        for (int p = 0; p < ev_index.count && found < max_hits; p++) {
+            int i = ev_index.order[p];
+            if (search.stamp[i] == cand && SearchMatch(i, q, n)) hits[found++] = i;
+        }
+    } else {
+        for (int k = 0; k < best->count; k++) {
+            uint32_t i = best->ids[k];
+            if (i >= (uint32_t)tracker.count || search.stamp[i] != cand) continue;
+            search.stamp[i] = cand + 1;
+            if (SearchMatch((int)i, q, n)) SearchKeep(hits, &found, max_hits, (int)i);
+        }
+    }
+    return found;
+}
+
+// True if the last SearchQuery stopped scanning before the end of the store
+bool SearchPartial(void) { return search.partial; }
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SAVE: escapes everything JSON requires, so LoadTracker reads back exactly what was written
+// ─────────────────────────────────────────────────────────────────────────────
+static void WriteEscaped(FILE *f, const char *s)
+{
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') { fputc('\\', f); fputc(ch, f); }
+        else if (ch == '\n') fputs("\\n", f);
+        else if (ch == '\t') fputs("\\t", f);
+        else if (ch == '\r') fputs("\\r", f);
+        else if (ch < 0x20)  fprintf(f, "\\u%04x", ch);
+        else fputc(ch, f);
+    }
+}
+
+// Writes any store (the live one or a copy) as JSON; safe to call off the main thread
+static bool WriteTrackerJson(const Tracker *t, const char *file)
+{
+    FILE *f = fopen(file, "w");
+    if (!f) return false;
+
+    fprintf(f, "[\n");
+    for (int i = 0; i < t->count; i++) {
+        char s1[64], s2[64];
+        struct tm tm;
+        strftime(s1, sizeof(s1), "%Y-%m-%d %H:%M", localtime_r(&t->start[i], &tm));
+        strftime(s2, sizeof(s2), "%Y-%m-%d %H:%M", localtime_r(&t->end[i], &tm));
+
+        fputs("  {\"name\":\"", f);
+        WriteEscaped(f, t->text.data + t->name[i]);
+        fprintf(f, "\",\"start\":\"%s\",\"end\":\"%s\",\"desc\":\"", s1, s2);
+        WriteEscaped(f, t->text.data + t->desc[i]);
+        fprintf(f, "\"}%s\n", (i < t->count-1) ? "," : "");
+    }
+    fprintf(f, "]\n");
+    bool ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    return (fclose(f) == 0) && ok;
+}
+
+// Only the timeline's own events; overlays stay in their files
+void SaveTracker(const char *file)
+{
+    Tracker own = tracker;
+    own.count = tracker.editable;
+    WriteTrackerJson(&own, file);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LOAD: single pass over the mapped file. Keys may come in any order, objects
+// may span lines, strings may be any length and use every JSON escape; unknown
+// keys and values of other types are skipped.
+// ─────────────────────────────────────────────────────────────────────────────
+typedef struct { char *data; size_t len, cap; } StrBuf;
+
+static bool StrBufReserve(StrBuf *b, size_t want)
+{
+    if (want <= b->cap) return true;
+    size_t cap = b->cap ? b->cap : 256;
+    while (cap < want) cap *= 2;
+    char *p = realloc(b->data, cap);
+    if (!p) return false;
+    b->data = p;
+    b->cap = cap;
+    return true;
+}
+
+static bool StrBufAppend(StrBuf *b, const char *s, size_t n)
+{
+    if (!StrBufReserve(b, b->len + n + 1)) return false;
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+    return true;
+}
+
+typedef struct { const char *p, *end; } JsonCursor;
+
+// First '"' or '\\' at or after p, eight bytes at a time
+static const char *FindQuoteOrBackslash(const char *p, const char *end)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const uint64_t ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL;
+    const uint64_t quotes = ones * '"', slashes = ones * '\\';
+    while (end - p >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        uint64_t q = w ^ quotes, s = w ^ slashes;
+        uint64_t hit = ((q - ones) & ~q & highs) | ((s - ones) & ~s & highs);
+        if (hit) return p + (__builtin_ctzll(hit) >> 3);
+        p += 8;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') p++;
+    return p;
+}
+
+static void JsonSkipSpace(JsonCursor *c)
+{
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\n' || *c->p == '\r' || *c->p == '\t')) c->p++;
+}
+
+static bool JsonAccept(JsonCursor *c, char ch)
+{
+    JsonSkipSpace(c);
+    if (c->p < c->end && *c->p == ch) { c->p++; return true; }
+    return false;
+}
+
+static int HexValue(char ch)
+{
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static bool JsonHex4(JsonCursor *c, unsigned *out)
+{
+    if (c->end - c->p < 4) return false;
+    unsigned v = 0;
+    for (int k = 0; k < 4; k++) {
+        int h = HexValue(c->p[k]);
+        if (h < 0) return false;
+        v = (v << 4) | (unsigned)h;
+    }
+    c->p += 4;
+    *out = v;
+    return true;
+}
+
+static bool AppendUtf8(StrBuf *b, unsigned cp)
+{
+    char u[4];
+    int n;
+    if (cp < 0x80)         { u[0] = (char)cp; n = 1; }
+    else if (cp < 0x800)   { u[0] = (char)(0xC0 | (cp >> 6));  u[1] = (char)(0x80 | (cp & 0x3F)); n = 2; }
+    else if (cp < 0x10000) { u[0] = (char)(0xE0 | (cp >> 12)); u[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                             u[2] = (char)(0x80 | (cp & 0x3F)); n = 3; }
+    else                   { u[0] = (char)(0xF0 | (cp >> 18)); u[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                             u[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); u[3] = (char)(0x80 | (cp & 0x3F)); n = 4; }
+    return StrBufAppend(b, u, n);
+}
+
+// Reads a string value (cursor on the opening quote) and decodes it into out
+static bool JsonString(JsonCursor *c, StrBuf *out)
+{
+    out->len = 0;
+    if (!StrBufReserve(out, 1)) return false;
+    out->data[0] = '\0';
+    if (!JsonAccept(c, '"')) return false;
+
+    for (;;) {
+        const char *q = FindQuoteOrBackslash(c->p, c->end);
+        if (q >= c->end) return false;
+        if (q > c->p && !StrBufAppend(out, c->p, q - c->p)) return false;
+        c->p = q + 1;
+        if (*q == '"') return true;
+
+        // Backslash escape
+        if (c->p >= c->end) return false;
+        char esc = *c->p++;
+        char ch;
+        switch (esc) {
+            case '"': case '\\': case '/': ch = esc; break;
+            case 'n': ch = '\n'; break;
+            case 't': ch = '\t'; break;
+            case 'r': ch = '\r'; break;
+            case 'b': ch = '\b'; break;
+            case 'f': ch = '\f'; break;
+            case 'u': {
+                unsigned cp;
+                if (!JsonHex4(c, &cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    unsigned lo;
+                    if (c->end - c->p >= 6 && c->p[0] == '\\' && c->p[1] == 'u') {
+                        c->p += 2;
+                        if (!JsonHex4(c, &lo)) return false;
+                        cp = (lo >= 0xDC00 && lo < 0xE000) ? 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00) : 0xFFFD;
+                    } else cp = 0xFFFD;
+                } else if (cp >= 0xDC00 && cp < 0xE000) cp = 0xFFFD;
+                if (!AppendUtf8(out, cp)) return false;
+                continue;
+            }
+            default: return false;
+        }
+        if (!StrBufAppend(out, &ch, 1)) return false;
+    }
+}
+
+// Skips any value: string, number, literal, or a nested object/array
+static bool JsonSkipValue(JsonCursor *c, StrBuf *scratch)
+{
+    JsonSkipSpace(c);
+    if (c->p >= c->end) return false;
+    if (*c->p == '"') return JsonString(c, scratch);
+
+    int depth = 0;
+    while (c->p < c->end) {
+        char ch = *c->p;
+        if (ch == '"') { if (!JsonString(c, scratch)) return false; continue; }
+        if (ch == '{' || ch == '[') depth++;
+        else if (ch == '}' || ch == ']') { if (depth == 0) return true; depth--; }
+        else if (ch == ',' && depth == 0) return true;
+        c->p++;
+        if (depth == 0 && (ch == '}' || ch == ']')) return true;
+    }
+    return depth == 0;
+}
+
+// Maps the whole file read-only; falls back to reading it into memory
+static const char *MapFile(const char *file, size_t *size, bool *mapped)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); *size = 0; return NULL; }
+    *size = (size_t)st.st_size;
+
+    void *p = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+        madvise(p, *size, MADV_SEQUENTIAL);
+        close(fd);
+        *mapped = true;
+        return p;
+    }
+
+    char *buf = malloc(*size);
+    size_t got = 0;
+    while (buf && got < *size) {
+        ssize_t r = read(fd, buf + got, *size - got);
+        if (r <= 0) break;
+        got += (size_t)r;
+    }
+    close(fd);
+    if (!buf || got != *size) { free(buf); return NULL; }
+    *mapped = false;
+    return buf;
+}
+
+static void UnmapFile(const char *data, size_t size, bool mapped)
+{
+    if (!data) return;
+    if (mapped) munmap((void*)data, size);
+    else free((void*)data);
+}
+
+// Appends the events of one JSON timeline to store `t`. A worker (any thread but
+// the main one) leaves times as wall-clock seconds and colors unset, both for
+// MergeLayer to fill in, since the zone table and rand() are main-thread only.
+static void ParseTimelineJson(const char *file, const char *data, size_t size, Tracker *t, bool worker)
+{
+    StrBuf key = {0}, name = {0}, desc = {0}, when = {0}, scratch = {0};
+    JsonCursor c = { data, data + size };
+    bool ok = JsonAccept(&c, '[');
+    bool first = true;
+    int kept = 0;
+
+    while (ok && !JsonAccept(&c, ']')) {
+        if (!first) {
+            if (!JsonAccept(&c, ',')) { ok = false; break; }
+            if (JsonAccept(&c, ']')) break;   // tolerate a trailing comma
+        }
+        first = false;
+        if (!JsonAccept(&c, '{')) { ok = false; break; }
+
+        int64_t s = 0, e = 0;
+        name.len = desc.len = 0;
+        if (StrBufReserve(&name, 1)) name.data[0] = '\0';
+        if (StrBufReserve(&desc, 1)) desc.data[0] = '\0';
+
+        bool first_key = true;
+        while (ok && !JsonAccept(&c, '}')) {
+            if (!first_key && !JsonAccept(&c, ',')) { ok = false; break; }
+            first_key = false;
+            if (!JsonString(&c, &key) || !JsonAccept(&c, ':')) { ok = false; break; }
+            JsonSkipSpace(&c);
+
+            bool is_string = c.p < c.end && *c.p == '"';
+            if      (is_string && strcmp(key.data, "name")  == 0) ok = JsonString(&c, &name);
+            else if (is_string && strcmp(key.data, "desc")  == 0) ok = JsonString(&c, &desc);
+            else if (is_string && strcmp(key.data, "start") == 0) { ok = JsonString(&c, &when); if (ok && !ParseWallClock(when.data, &s)) s = 0; }
+            else if (is_string && strcmp(key.data, "end")   == 0) { ok = JsonString(&c, &when); if (ok && !ParseWallClock(when.data, &e)) e = 0; }
+            else ok = JsonSkipValue(&c, &scratch);
+        }
+        if (!ok) break;
+
+        if (!worker) {
+            s = s ? UtcFromLocal(s) : 0;
+            e = e ? UtcFromLocal(e) : 0;
+        }
+        if (!s || e <= s) continue;
+        int i = StoreAppend(t, name.data, desc.data, (time_t)s, (time_t)e);
+        if (i < 0) break;
+        if (!worker) t->color[i] = (EventColor){RandomValue(90,230), RandomValue(90,230), RandomValue(110,240), 255};
+        kept++;
+    }
+    if (!ok) Warn("%s: malformed JSON near byte %zu, kept %d events",
+                      file, (size_t)(c.p - data), kept);
+
+    free(key.data); free(name.data); free(desc.data); free(when.data); free(scratch.data);
+}
+
+void LoadTracker(const char *file)
+{
+    size_t size = 0;
+    bool mapped = false;
+    const char *data = MapFile(file, &size, &mapped);
+    if (!data) return;
+
+    TrackerClear();
+    ParseTimelineJson(file, data, size, &tracker, false);
+    tracker.editable = tracker.count;
+    tracker.text.live = tracker.text.used;
+    UnmapFile(data, size, mapped);
+
+    // TrackerClear left the index dirty and nothing above touched it; sort and stack once
+    IndexBuild();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Binary snapshot – "<file>.snap" next to the JSON holds the store exactly as it
+// sits in memory: fixed-width columns, the sorted order and track layout, and
+// the string arena as one blob that events address by offset (shared strings
+// share an offset). It is stamped with the size
+// and mtime of the JSON it mirrors, so a JSON edited by hand (or by anything
+// else) is simply reparsed and the snapshot rewritten.
+// ─────────────────────────────────────────────────────────────────────────────
+#define SNAP_MAGIC   "TTSNAP\r\n"
+#define SNAP_VERSION 2
+
+typedef struct {
+    char     magic[8];
+    uint32_t version, byte_order;
+    uint64_t count, blob_size;
+    uint64_t journal_seq;   // last journal record folded into this snapshot
+    int64_t  json_size, json_mtime_sec, json_mtime_nsec;
+    // Byte offsets of each section from the start of the file
+    uint64_t off_start, off_end, off_track, off_color, off_name, off_desc, off_order, off_blob;
+} SnapHeader;
+
+static void SnapshotPath(const char *json, char *out, size_t size)
+{
+    snprintf(out, size, "%s.snap", json);
+}
+
+static bool JsonStamp(const char *json, SnapHeader *h)
+{
+    struct stat st;
+    if (stat(json, &st) != 0) return false;
+    h->json_size       = st.st_size;
+    h->json_mtime_sec  = st.st_mtim.tv_sec;
+    h->json_mtime_nsec = st.st_mtim.tv_nsec;
+    return true;
+}
+
+static bool WriteAll(FILE *f, const void *p, size_t n) { return n == 0 || fwrite(p, 1, n, f) == n; }
+
+// Writes the snapshot of store `t` (sorted as `order`) to `path` via a temp file +
+// rename, stamped with the JSON file `stamp_from` that holds the same events
+static bool WriteSnapshot(const Tracker *t, const int *order, uint64_t seq, const char *stamp_from, const char *path)
+{
+    uint64_t n = (uint64_t)t->count;
+
+    SnapHeader h = {0};
+    memcpy(h.magic, SNAP_MAGIC, 8);
+    h.version = SNAP_VERSION;
+    h.byte_order = 0x01020304;
+    h.count = n;
+    h.journal_seq = seq;
+    if (!JsonStamp(stamp_from, &h)) return false;
+
+    h.blob_size = t->text.used;
+
+    h.off_start = sizeof(SnapHeader);
+    h.off_end   = h.off_start + n * sizeof(int64_t);
+    h.off_track = h.off_end   + n * sizeof(int64_t);
+    h.off_color = h.off_track + n * sizeof(int32_t);
+    h.off_name  = h.off_color + n * sizeof(uint32_t);
+    h.off_desc  = h.off_name  + n * sizeof(uint32_t);
+    h.off_order = h.off_desc  + n * sizeof(uint32_t);
+    h.off_blob  = h.off_order + n * sizeof(int32_t);
+
+    char tmp[1040];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+
+    bool ok = WriteAll(f, &h, sizeof(h));
+    for (uint64_t i = 0; ok && i < n; i++) { int64_t v = t->start[i]; ok = WriteAll(f, &v, sizeof(v)); }
+    for (uint64_t i = 0; ok && i < n; i++) { int64_t v = t->end[i];   ok = WriteAll(f, &v, sizeof(v)); }
+    for (uint64_t i = 0; ok && i < n; i++) { int32_t v = t->track[i]; ok = WriteAll(f, &v, sizeof(v)); }
+    for (uint64_t i = 0; ok && i < n; i++) ok = WriteAll(f, &t->color[i], sizeof(uint32_t));
+
+    ok = ok && WriteAll(f, t->name, n * sizeof(uint32_t)) && WriteAll(f, t->desc, n * sizeof(uint32_t));
+    for (uint64_t p = 0; ok && p < n; p++) { int32_t v = order[p]; ok = WriteAll(f, &v, sizeof(v)); }
+    ok = ok && WriteAll(f, t->text.data, t->text.used);
+
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) { remove(tmp); return false; }
+    return true;
+}
+
+// Loads the store from the snapshot if it matches the current JSON and reports the
+// journal position it was taken at. Returns false (leaving the store untouched)
+// when there is no usable snapshot.
+bool LoadSnapshot(const char *json, uint64_t *seq)
+{
+    char path[1024];
+    SnapshotPath(json, path, sizeof(path));
+
+    size_t size = 0;
+    bool mapped = false;
+    const char *data = MapFile(path, &size, &mapped);
+    if (!data) return false;
+
+    SnapHeader h, now = {0};
+    bool ok = size >= sizeof(h);
+    if (ok) memcpy(&h, data, sizeof(h));
+    ok = ok && memcmp(h.magic, SNAP_MAGIC, 8) == 0 && h.version == SNAP_VERSION &&
+         h.byte_order == 0x01020304 && h.count <= INT32_MAX && JsonStamp(json, &now) &&
+         h.json_size == now.json_size && h.json_mtime_sec == now.json_mtime_sec &&
+         h.json_mtime_nsec == now.json_mtime_nsec;
+
+    uint64_t n = ok ? h.count : 0;
+    ok = ok && h.off_start == sizeof(SnapHeader) &&
+         h.off_end   == h.off_start + n * sizeof(int64_t) &&
+         h.off_track == h.off_end   + n * sizeof(int64_t) &&
+         h.off_color == h.off_track + n * sizeof(int32_t) &&
+         h.off_name  == h.off_color + n * sizeof(uint32_t) &&
+         h.off_desc  == h.off_name  + n * sizeof(uint32_t) &&
+         h.off_order == h.off_desc  + n * sizeof(uint32_t) &&
+         h.off_blob  == h.off_order + n * sizeof(int32_t) &&
+         h.off_blob + h.blob_size == size && h.blob_size <= UINT32_MAX &&
+         (h.blob_size == 0 || data[size - 1] == '\0');
+    ok = ok && TrackerReserve((int)n);
+    if (!ok) { UnmapFile(data, size, mapped); return false; }
+
+    TrackerClear();
+    const int64_t  *start = (const int64_t*)(data + h.off_start);
+    const int64_t  *end   = (const int64_t*)(data + h.off_end);
+    const int32_t  *track = (const int32_t*)(data + h.off_track);
+    const uint32_t *name  = (const uint32_t*)(data + h.off_name);
+    const uint32_t *desc  = (const uint32_t*)(data + h.off_desc);
+    const char     *blob  = data + h.off_blob;
+
+    if (sizeof(time_t) == sizeof(int64_t)) {
+        memcpy(tracker.start, start, n * sizeof(int64_t));
+        memcpy(tracker.end,   end,   n * sizeof(int64_t));
+    } else {
+        for (uint64_t i = 0; i < n; i++) { tracker.start[i] = (time_t)start[i]; tracker.end[i] = (time_t)end[i]; }
+    }
+    for (uint64_t i = 0; i < n; i++) tracker.track[i] = track[i];
+    memcpy(tracker.color, data + h.off_color, n * sizeof(uint32_t));
+
+    // The blob becomes the arena as is; the interning table is rebuilt from the
+    // handles, and a snapshot whose strings aren't shared yet gets them merged
+    ok = TextReserve(&tracker.text, h.blob_size);
+    if (ok) {
+        memcpy(tracker.text.data, blob, h.blob_size);
+        tracker.text.used = (uint32_t)h.blob_size;
+    }
+    bool merged = false;
+    for (uint64_t i = 0; ok && i < n; i++) {
+        ok = name[i] < h.blob_size && desc[i] < h.blob_size;
+        TextId nm = ok ? TextAdopt(&tracker.text, name[i]) : TEXT_NONE;
+        TextId ds = ok ? TextAdopt(&tracker.text, desc[i]) : TEXT_NONE;
+        ok = nm != TEXT_NONE && ds != TEXT_NONE;
+        merged |= nm != name[i] || ds != desc[i];
+        tracker.name[i]  = nm;
+        tracker.desc[i]  = ds;
+        tracker.layer[i] = 0;
+        tracker.count = tracker.editable = (int)i + 1;
+    }
+    if (ok && merged) ok = StoreCompactText(&tracker);
+    if (!ok) {
+        TrackerClear();
+        UnmapFile(data, size, mapped);
+        return false;
+    }
+    tracker.text.live = tracker.text.used;
+
+    IndexAdopt((const int32_t*)(data + h.off_order));
+    UnmapFile(data, size, mapped);
+    *seq = h.journal_seq;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Journal – every add/edit/delete is appended to "<file>.journal" as one JSON
+// line the moment it happens, so an edit costs one small write and a crash
+// loses nothing. Records are numbered; the snapshot remembers the last number
+// it contains, and startup replays whatever came after it.
+//
+// Autosave: shortly after editing stops (or every AUTOSAVE_MAX_SECS while it
+// goes on, or once the journal gets long) a worker thread rewrites JSON +
+// snapshot from a copy of the store, fsyncs and renames them into place, and the
+// journal is cut down to the records written meanwhile. The frame only pays for
+// the copy.
+//
+// Records refer to events by index. That is fine because replay starts from
+// exactly the store they were written against and repeats the same swap-removes.
+// Overlay layers are read-only and kept after the timeline's own events, so
+// they never show up here and don't shift those indices.
+// ─────────────────────────────────────────────────────────────────────────────
+#define JOURNAL_COMPACT_AT  2048
+#define AUTOSAVE_IDLE_SECS  2.0
+#define AUTOSAVE_MAX_SECS   30.0
+
+typedef struct {
+    FILE *f;
+    char json[1024], path[1040];
+    uint64_t seq;           // last record written (or replayed)
+    int since_compact;      // records written since the last compaction attempt
+    uint64_t saved_seq;     // last record the files on disk include
+    double last_edit, last_save;
+    double retry_at;        // after a failed save, no new attempt before this
+    int failures;           // failed saves in a row
+
+    // Background compaction
+    pthread_t worker;
+    bool running, ok;
+    atomic_bool done;
+    long cut;               // journal size when the copy was taken
+    uint64_t cut_seq;
+    Tracker copy;
+    int *order;
+} Journal;
+
+static Journal journal;
+
+static bool JournalBegin(const char *op)
+{
+    if (!journal.f) return false;
+    fprintf(journal.f, "{\"seq\":%llu,\"op\":\"%s\"", (unsigned long long)++journal.seq, op);
+    return true;
+}
+
+static void JournalEnd(void)
+{
+    fputs("}\n", journal.f);
+    fflush(journal.f);
+    journal.since_compact++;
+    journal.last_edit = NowSeconds();
+}
+
+static void JournalEvent(int i)
+{
+    fprintf(journal.f, ",\"start\":%lld,\"end\":%lld,\"name\":\"",
+            (long long)tracker.start[i], (long long)tracker.end[i]);
+    WriteEscaped(journal.f, EventName(i));
+    fputs("\",\"desc\":\"", journal.f);
+    WriteEscaped(journal.f, EventDesc(i));
+    fputc('"', journal.f);
+}
+
+void JournalAdd(int i)
+{
+    if (i < 0 || i >= tracker.editable || !JournalBegin("add")) return;
+    EventColor c = tracker.color[i];
+    fprintf(journal.f, ",\"i\":%d,\"color\":\"%02x%02x%02x%02x\"", i, c.r, c.g, c.b, c.a);
+    JournalEvent(i);
+    JournalEnd();
+}
+
+void JournalSet(int i)
+{
+    if (i < 0 || i >= tracker.editable || !JournalBegin("set")) return;
+    fprintf(journal.f, ",\"i\":%d", i);
+    JournalEvent(i);
+    JournalEnd();
+}
+
+void JournalDelete(int i)
+{
+    if (i < 0 || i >= tracker.editable || !JournalBegin("del")) return;
+    fprintf(journal.f, ",\"i\":%d", i);
+    JournalEnd();
+}
+
+// Reads an integer value; journal numbers are never fractional
+static bool JsonInt(JsonCursor *c, long long *out)
+{
+    JsonSkipSpace(c);
+    char buf[32];
+    size_t n = 0;
+    while (c->p + n < c->end && n < sizeof(buf) - 1 && (c->p[n] == '-' || (c->p[n] >= '0' && c->p[n] <= '9'))) {
+        buf[n] = c->p[n];
+        n++;
+    }
+    if (n == 0) return false;
+    buf[n] = '\0';
+    char *stop;
+    *out = strtoll(buf, &stop, 10);
+    c->p += n;
+    return *stop == '\0';
+}
+
+// Replays records after *seq onto the store. Returns how many bytes of the file
+// are intact records, so a line torn by a crash can be cut off.
+static size_t JournalReplay(const char *path, uint64_t *seq, int *applied)
+{
+    size_t size = 0, valid = 0;
+    bool mapped = false;
+    const char *data = MapFile(path, &size, &mapped);
+    *applied = 0;
+    if (!data) return 0;
+
+    StrBuf key = {0}, op = {0}, name = {0}, desc = {0}, color = {0}, scratch = {0};
+    JsonCursor c = { data, data + size };
+
+    for (;;) {
+        JsonSkipSpace(&c);
+        if (c.p >= c.end || !JsonAccept(&c, '{')) break;
+
+        long long rec = 0, i = -1, s = 0, e = 0;
+        op.len = name.len = desc.len = color.len = 0;
+        bool ok = true, first_key = true;
+        while (ok && !JsonAccept(&c, '}')) {
+            if (!first_key && !JsonAccept(&c, ',')) { ok = false; break; }
+            first_key = false;
+            if (!JsonString(&c, &key) || !JsonAccept(&c, ':')) { ok = false; break; }
+
+            if      (strcmp(key.data, "seq")   == 0) ok = JsonInt(&c, &rec);
+            else if (strcmp(key.data, "op")    == 0) ok = JsonString(&c, &op);
+            else if (strcmp(key.data, "i")     == 0) ok = JsonInt(&c, &i);
+            else if (strcmp(key.data, "start") == 0) ok = JsonInt(&c, &s);
+            else if (strcmp(key.data, "end")   == 0) ok = JsonInt(&c, &e);
+            else if (strcmp(key.data, "name")  == 0) ok = JsonString(&c, &name);
+            else if (strcmp(key.data, "desc")  == 0) ok = JsonString(&c, &desc);
+            else if (strcmp(key.data, "color") == 0) ok = JsonString(&c, &color);
+            else ok = JsonSkipValue(&c, &scratch);
+        }
+        if (!ok || op.len == 0) break;
+
+        // Already folded into the snapshot (compaction finished but the journal wasn't cut yet)
+        if ((uint64_t)rec <= *seq) { valid = (size_t)(c.p - data); continue; }
+        if ((uint64_t)rec != *seq + 1) break;
+
+        const char *nm = name.len ? name.data : "", *ds = desc.len ? desc.data : "";
+        if (strcmp(op.data, "add") == 0) {
+            // Older journals have no "i": those adds always appended
+            if (i > tracker.editable) break;
+            int k = TrackerInsert(i >= 0 ? (int)i : tracker.editable, nm, ds, (time_t)s, (time_t)e);
+            if (k < 0) break;
+            if (color.len == 8) {
+                unsigned char rgba[4];
+                for (int b = 0; b < 4; b++)
+                    rgba[b] = (unsigned char)(HexValue(color.data[2*b]) << 4 | HexValue(color.data[2*b+1]));
+                tracker.color[k] = (EventColor){ rgba[0], rgba[1], rgba[2], rgba[3] };
+            }
+        } else if (strcmp(op.data, "set") == 0 && i >= 0 && i < tracker.editable) {
+            TrackerSetText((int)i, nm, ds);
+            tracker.start[i] = (time_t)s;
+            tracker.end[i]   = (time_t)e;
+            IndexMoved((int)i);
+        } else if (strcmp(op.data, "del") == 0 && i >= 0 && i < tracker.editable) {
+            TrackerRemove((int)i);
+        } else break;
+
+        *seq = (uint64_t)rec;
+        (*applied)++;
+        valid = (size_t)(c.p - data);
+    }
+    // Include the newline after the last good record
+    while (valid < size && (data[valid] == '\n' || data[valid] == '\r')) valid++;
+
+    free(key.data); free(op.data); free(name.data); free(desc.data); free(color.data); free(scratch.data);
+    UnmapFile(data, size, mapped);
+    return valid;
+}
+
+// Makes renames inside the file's directory durable
+static void SyncParentDir(const char *file)
+{
+    char dir[1024];
+    snprintf(dir, sizeof(dir), "%s", file);
+    char *slash = strrchr(dir, '/');
+    if (slash) *(slash == dir ? slash + 1 : slash) = '\0';
+    else snprintf(dir, sizeof(dir), ".");
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+}
+
+// Writes JSON and snapshot through "<file>.tmp" so the JSON is replaced in one
+// rename. With require_snapshot the JSON is only replaced once the snapshot
+// (and with it the journal position) is on disk.
+static bool WriteBase(const Tracker *t, const int *order, uint64_t seq, bool require_snapshot)
+{
+    char tmp[1040], snap[1040];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", journal.json);
+    SnapshotPath(journal.json, snap, sizeof(snap));
+
+    if (!WriteTrackerJson(t, tmp)) { remove(tmp); return false; }
+    if (!WriteSnapshot(t, order, seq, tmp, snap) && require_snapshot) { remove(tmp); return false; }
+    if (rename(tmp, journal.json) != 0) return false;
+    SyncParentDir(journal.json);
+    return true;
+}
+
+// A crash between the snapshot rename and the JSON rename leaves the new JSON
+// as "<file>.tmp" with a snapshot already stamped for it; finish the job.
+static void RecoverPendingJson(const char *json)
+{
+    char tmp[1040], snap[1040];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", json);
+    SnapshotPath(json, snap, sizeof(snap));
+
+    SnapHeader h, now = {0};
+    FILE *f = fopen(snap, "rb");
+    if (!f) return;
+    bool read = fread(&h, sizeof(h), 1, f) == 1;
+    fclose(f);
+    if (read && JsonStamp(tmp, &now) && h.json_size == now.json_size &&
+        h.json_mtime_sec == now.json_mtime_sec && h.json_mtime_nsec == now.json_mtime_nsec)
+        rename(tmp, json);
+}
+
+static void *CompactWorker(void *arg)
+{
+    (void)arg;
+    journal.ok = WriteBase(&journal.copy, journal.order, journal.cut_seq, true);
+    atomic_store(&journal.done, true);
+    return NULL;
+}
+
+// Deep copy of the timeline's own events plus their sorted order, for writing
+// JSON + snapshot. With overlays loaded (or the timeline hidden) the tracks
+// don't describe the file alone, so they're cleared and the next load of the
+// snapshot stacks again instead of adopting them.
+static bool CopyOwnEvents(Tracker *dst, int **order)
+{
+    IndexEnsure();
+    *dst = (Tracker){0};
+    Tracker own = tracker;
+    own.count = tracker.editable;
+    *order = malloc((own.count > 0 ? own.count : 1) * sizeof(int));
+    if (!*order || !TrackerCopy(dst, &own)) {
+        TrackerFreeCopy(dst);
+        free(*order);
+        *order = NULL;
+        return false;
+    }
+
+    int k = 0;
+    for (int p = 0; p < ev_index.count; p++)
+        if (ev_index.order[p] < own.count && k < own.count) (*order)[k++] = ev_index.order[p];
+    if (k != own.count) {
+        TrackerFreeCopy(dst);
+        free(*order);
+        *order = NULL;
+        return false;
+    }
+    // Overlay strings share the arena; leave them out of the files
+    if (tracker.count != tracker.editable) StoreCompactText(dst);
+    if (tracker.count != tracker.editable || layers[0].hidden)
+        for (int i = 0; i < own.count; i++) dst->track[i] = -1;
+    return true;
+}
+
+static void JournalCompactBegin(void)
+{
+    if (journal.running || !journal.f) return;
+    journal.since_compact = 0;
+    journal.last_save = NowSeconds();
+    if (!CopyOwnEvents(&journal.copy, &journal.order)) return;
+
+    fflush(journal.f);
+    journal.cut = ftell(journal.f);
+    journal.cut_seq = journal.seq;
+    atomic_store(&journal.done, false);
+    journal.running = pthread_create(&journal.worker, NULL, CompactWorker, NULL) == 0;
+    if (!journal.running) {
+        TrackerFreeCopy(&journal.copy);
+        free(journal.order);
+        journal.order = NULL;
+    }
+}
+
+// Drops the records the new snapshot already holds: copies what was appended
+// after the cut into a fresh journal and swaps it in
+static void JournalTrim(void)
+{
+    char tmp[1060];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", journal.path);
+    fflush(journal.f);
+
+    FILE *in = fopen(journal.path, "rb"), *out = in ? fopen(tmp, "wb") : NULL;
+    bool ok = in && out && fseek(in, journal.cut, SEEK_SET) == 0;
+    char buf[65536];
+    size_t n;
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0) ok = fwrite(buf, 1, n, out) == n;
+    if (in) fclose(in);
+    if (out && fclose(out) != 0) ok = false;
+    if (!ok) { remove(tmp); return; }
+
+    fclose(journal.f);
+    if (rename(tmp, journal.path) != 0) remove(tmp);
+    journal.f = fopen(journal.path, "a");
+}
+
+// True while edits wait for autosave or a save is running; JournalPoll needs
+// frames then. Not while backing off after a failed save: the next input brings
+// the frames back, and with them the retry.
+bool JournalBusy(void)
+{
+    return journal.running || (journal.seq != journal.saved_seq && NowSeconds() >= journal.retry_at);
+}
+
+// Last record written; changes with every edit that reaches the journal
+uint64_t JournalSeq(void)
+{
+    return journal.seq;
+}
+
+// Called once per frame: finishes a save that is done, or starts one when due
+void JournalPoll(void)
+{
+    if (journal.running) {
+        if (!atomic_load(&journal.done)) return;
+        pthread_join(journal.worker, NULL);
+        journal.running = false;
+        TrackerFreeCopy(&journal.copy);
+        free(journal.order);
+        journal.order = NULL;
+        if (journal.ok) {
+            if (journal.failures) Warn("Saved %s again", journal.json);
+            journal.failures = 0;
+            journal.retry_at = 0;
+            journal.saved_seq = journal.cut_seq;
+            JournalTrim();
+        } else {
+            // Retries back off from AUTOSAVE_IDLE_SECS up to AUTOSAVE_MAX_SECS; one warning per streak
+            if (journal.failures++ == 0) Warn("Could not save %s, keeping the journal and retrying", journal.json);
+            double delay = AUTOSAVE_IDLE_SECS * (double)(1u << (journal.failures < 8 ? journal.failures - 1 : 7));
+            journal.retry_at = NowSeconds() + (delay < AUTOSAVE_MAX_SECS ? delay : AUTOSAVE_MAX_SECS);
+        }
+        return;
+    }
+
+    if (journal.seq == journal.saved_seq) return;
+    double now = NowSeconds();
+    if (now < journal.retry_at) return;
+    if (now - journal.last_edit >= AUTOSAVE_IDLE_SECS ||
+        now - journal.last_save >= AUTOSAVE_MAX_SECS ||
+        journal.since_compact >= JOURNAL_COMPACT_AT)
+        JournalCompactBegin();
+}
+
+// Startup path: the snapshot when it is current (plus any journaled edits made
+// after it), otherwise parse the JSON and write a fresh snapshot
+void LoadTimeline(const char *json)
+{
+    snprintf(journal.json, sizeof(journal.json), "%s", json);
+    snprintf(journal.path, sizeof(journal.path), "%s.journal", json);
+    RecoverPendingJson(json);
+
+    uint64_t seq = 0;
+    int applied = 0;
+    if (LoadSnapshot(json, &seq)) {
+        struct stat st;
+        size_t valid = JournalReplay(journal.path, &seq, &applied);
+        if (stat(journal.path, &st) == 0 && (size_t)st.st_size > valid) {
+            Warn("%s: dropping %lld bytes after the last complete record",
+                     journal.path, (long long)st.st_size - (long long)valid);
+            if (truncate(journal.path, (off_t)valid) != 0) remove(journal.path);
+        }
+    } else {
+        // No snapshot to replay onto, so the journal (if any) can't be placed; keep it aside
+        LoadTracker(json);
+        if (access(journal.path, F_OK) == 0) {
+            char stale[1060];
+            snprintf(stale, sizeof(stale), "%s.stale", journal.path);
+            Warn("%s does not match %s, moved to %s", journal.path, json, stale);
+            rename(journal.path, stale);
+        }
+        char snap[1040];
+        SnapshotPath(json, snap, sizeof(snap));
+        IndexEnsure();
+        WriteSnapshot(&tracker, ev_index.order, 0, json, snap);
+    }
+
+    journal.saved_seq = seq - applied;   // replayed records are only on disk in the journal
+    journal.seq = seq;
+    journal.last_save = journal.last_edit = NowSeconds();
+    journal.f = fopen(journal.path, "a");
+}
+
+// Waits out a background save whose result no longer matters
+static void JournalJoin(void)
+{
+    if (!journal.running) return;
+    pthread_join(journal.worker, NULL);
+    journal.running = false;
+    TrackerFreeCopy(&journal.copy);
+    free(journal.order);
+    journal.order = NULL;
+}
+
+// Writes JSON + snapshot right away and starts an empty journal, for bulk
+// changes that would be too many records to journal one at a time. False if
+// no timeline is open or the write failed; the journal is untouched then.
+static bool JournalCheckpoint(void)
+{
+    if (!journal.f) return false;
+    JournalJoin();
+    Tracker own;
+    int *order;
+    bool ok = CopyOwnEvents(&own, &order) && WriteBase(&own, order, journal.seq, true);
+    if (order) { TrackerFreeCopy(&own); free(order); }
+    if (!ok) return false;
+
+    // Replay would skip the old records anyway; dropping them is just tidier
+    FILE *f = fopen(journal.path, "w");
+    if (f) { fclose(journal.f); journal.f = f; }
+    journal.saved_seq = journal.seq;
+    journal.since_compact = 0;
+    journal.last_save = NowSeconds();
+    return true;
+}
+
+// Read-only open for the command line: the same snapshot + journal (or JSON)
+// as LoadTimeline, but nothing gets written and the journal stays closed.
+// Unless the events get drawn, the LOD pyramid (most of a load's time) is
+// skipped for good. False if there is no timeline to read.
+bool PeekTimeline(const char *json, bool drawn)
+{
+    lod.off = !drawn;
+    char path[1040];
+    snprintf(path, sizeof(path), "%s.journal", json);
+    uint64_t seq = 0;
+    int applied = 0;
+    if (LoadSnapshot(json, &seq)) JournalReplay(path, &seq, &applied);
+    else if (access(json, R_OK) == 0) LoadTracker(json);
+    else return false;
+    IndexEnsure();
+    return true;
+}
+
+// Shutdown: fold everything into JSON + snapshot and drop the journal
+void CloseTimeline(void)
+{
+    JournalJoin();
+    IndexEnsure();
+    bool ok;
+    if (tracker.count == tracker.editable && !layers[0].hidden) {
+        ok = WriteBase(&tracker, ev_index.order, journal.seq, false);
+    } else {
+        Tracker own;
+        int *order;
+        ok = CopyOwnEvents(&own, &order) && WriteBase(&own, order, journal.seq, false);
+        if (order) { TrackerFreeCopy(&own); free(order); }
+    }
+    if (journal.f) fclose(journal.f);
+    journal.f = NULL;
+    if (ok) remove(journal.path);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Undo history – a log of edit records rather than copies of the store. A record
+// holds one event's index, its start/end before and after, and for each string
+// only the part that changed (prefix and suffix shared by the old and new text
+// are left out). Adds and deletes are the same record with one side empty, so
+// undoing one is redoing the other. Undo and redo go back through TrackerInsert /
+// TrackerRemove / IndexMoved and the journal like any other edit, so the index,
+// layout and files follow along incrementally.
+//
+// Indices stay valid because every step is undone in reverse order:
+// TrackerInsert(i) puts back exactly what TrackerRemove(i) swapped away.
+// Records are dropped oldest first once they take more than HISTORY_BUDGET.
+// ─────────────────────────────────────────────────────────────────────────────
+#define HISTORY_BUDGET (4u << 20)   // bytes of records kept for undo
+
+enum { EDIT_ADD, EDIT_DELETE, EDIT_SET };
+
+typedef struct {
+    unsigned char kind;
+    EventColor color;           // adds and deletes: the event's own
+    int i;
+    time_t start[2], end[2];    // [0] before, [1] after
+    uint32_t name_at, name_tail, desc_at, desc_tail;   // shared prefix / suffix lengths
+    uint32_t len[4];            // changed middles: name before, name after, desc before, desc after
+    char *text;                 // the four middles back to back
+} EditRecord;
+
+static struct {
+    EditRecord *ring;
+    int capacity, head, count, cursor;   // records [head, head+cursor) can be undone, the rest redone
+    size_t bytes;
+
+    // Edit in progress (a drag, or typing into the inputs): the event as it was
+    int pending;
+    time_t pending_start, pending_end;
+    char *pending_name, *pending_desc;
+} history = { .pending = -1 };
+
+static EditRecord *HistoryAt(int k) { return &history.ring[(history.head + k) & (history.capacity - 1)]; }
+
+static size_t EditBytes(const EditRecord *r)
+{
+    return sizeof(EditRecord) + r->len[0] + r->len[1] + r->len[2] + r->len[3];
+}
+
+static void EditFree(EditRecord *r)
+{
+    history.bytes -= EditBytes(r);
+    free(r->text);
+    r->text = NULL;
+}
+
+// Shared prefix and suffix of a and b; the suffix never overlaps the prefix
+static void TextDiff(const char *a, const char *b, uint32_t *at, uint32_t *tail, uint32_t *len_a, uint32_t *len_b)
+{
+    size_t na = strlen(a), nb = strlen(b), p = 0, q = 0;
+    while (p < na && p < nb && a[p] == b[p]) p++;
+    while (q < na - p && q < nb - p && a[na-1-q] == b[nb-1-q]) q++;
+    *at = (uint32_t)p;
+    *tail = (uint32_t)q;
+    *len_a = (uint32_t)(na - p - q);
+    *len_b = (uint32_t)(nb - p - q);
+}
+
+static void HistoryForget(void)
+{
+    while (history.count > 0) EditFree(HistoryAt(--history.count));
+    history.cursor = 0;
+}
+
+// An edit that can't be recorded would leave the older records pointing at the
+// wrong events, so on OOM the history starts over instead
+static void HistoryPush(EditRecord *r, const char *name[2], const char *desc[2])
+{
+    TextDiff(name[0], name[1], &r->name_at, &r->name_tail, &r->len[0], &r->len[1]);
+    TextDiff(desc[0], desc[1], &r->desc_at, &r->desc_tail, &r->len[2], &r->len[3]);
+    size_t n = (size_t)r->len[0] + r->len[1] + r->len[2] + r->len[3];
+    r->text = malloc(n ? n : 1);
+    if (!r->text) { HistoryForget(); return; }
+    char *t = r->text;
+    memcpy(t, name[0] + r->name_at, r->len[0]); t += r->len[0];
+    memcpy(t, name[1] + r->name_at, r->len[1]); t += r->len[1];
+    memcpy(t, desc[0] + r->desc_at, r->len[2]); t += r->len[2];
+    memcpy(t, desc[1] + r->desc_at, r->len[3]);
+
+    // A new edit ends whatever could have been redone
+    while (history.count > history.cursor) EditFree(HistoryAt(--history.count));
+    if (history.count == history.capacity) {
+        int cap = history.capacity ? history.capacity * 2 : 64;
+        EditRecord *ring = malloc((size_t)cap * sizeof(EditRecord));
+        if (!ring) { free(r->text); HistoryForget(); return; }
+        for (int k = 0; k < history.count; k++) ring[k] = *HistoryAt(k);
+        free(history.ring);
+        history.ring = ring;
+        history.capacity = cap;
+        history.head = 0;
+    }
+    *HistoryAt(history.count++) = *r;
+    history.cursor = history.count;
+    history.bytes += EditBytes(r);
+
+    while (history.bytes > HISTORY_BUDGET && history.count > 1) {
+        EditFree(HistoryAt(0));
+        history.head = (history.head + 1) & (history.capacity - 1);
+        history.count--;
+        history.cursor--;
+    }
+}
+
+// Records the edit in progress, if it changed anything
+void HistoryFlush(void)
+{
+    int i = history.pending;
+    if (i < 0) return;
+    history.pending = -1;
+    if (i < tracker.editable && (tracker.start[i] != history.pending_start || tracker.end[i] != history.pending_end ||
+        strcmp(EventName(i), history.pending_name) || strcmp(EventDesc(i), history.pending_desc))) {
+        EditRecord r = { .kind = EDIT_SET, .i = i,
+                         .start = { history.pending_start, tracker.start[i] },
+                         .end   = { history.pending_end,   tracker.end[i] } };
+        const char *name[2] = { history.pending_name, EventName(i) };
+        const char *desc[2] = { history.pending_desc, EventDesc(i) };
+        HistoryPush(&r, name, desc);
+    }
+    free(history.pending_name);
+    free(history.pending_desc);
+    history.pending_name = history.pending_desc = NULL;
+}
+
+// Event i is about to change; the change is recorded at the next HistoryFlush (or
+// any other history call), so a whole drag or a burst of typing is one step
+void HistoryEditing(int i)
+{
+    if (i == history.pending) return;
+    HistoryFlush();
+    if (i < 0 || i >= tracker.editable) return;
+    history.pending_name = DupText(EventName(i));
+    history.pending_desc = DupText(EventDesc(i));
+    if (!history.pending_name || !history.pending_desc) {
+        HistoryClear();
+        return;
+    }
+    history.pending = i;
+    history.pending_start = tracker.start[i];
+    history.pending_end = tracker.end[i];
+}
+
+static void HistoryWhole(int kind, int i)
+{
+    HistoryFlush();
+    if (i < 0 || i >= tracker.editable) return;
+    int side = kind == EDIT_ADD;   // the side the event is on
+    EditRecord r = { .kind = (unsigned char)kind, .color = tracker.color[i], .i = i,
+                     .start = { tracker.start[i], tracker.start[i] }, .end = { tracker.end[i], tracker.end[i] } };
+    const char *name[2] = { "", "" }, *desc[2] = { "", "" };
+    name[side] = EventName(i);
+    desc[side] = EventDesc(i);
+    HistoryPush(&r, name, desc);
+}
+
+void HistoryAdded(int i)    { HistoryWhole(EDIT_ADD, i); }
+void HistoryRemoving(int i) { HistoryWhole(EDIT_DELETE, i); }
+
+// current with its changed middle (at, tail kept) replaced by `mid`
+static char *TextPatch(const char *current, uint32_t at, uint32_t tail, const char *mid, uint32_t len)
+{
+    size_t n = strlen(current);
+    if (at + (size_t)tail > n) return NULL;
+    char *out = malloc(at + len + tail + 1);
+    if (!out) return NULL;
+    memcpy(out, current, at);
+    memcpy(out + at, mid, len);
+    memcpy(out + at + len, current + n - tail, tail);
+    out[at + len + tail] = '\0';
+    return out;
+}
+
+// Moves record r's event to side `to` (0 = before, 1 = after)
+static bool EditApply(const EditRecord *r, int to)
+{
+    int i = r->i;
+    const char *name_mid = r->text + (to ? r->len[0] : 0);
+    const char *desc_mid = r->text + r->len[0] + r->len[1] + (to ? r->len[2] : 0);
+
+    bool present = r->kind == EDIT_SET || (r->kind == EDIT_ADD) == (to == 1);
+    if (!present) {
+        if (i >= tracker.editable) return false;
+        JournalDelete(i);
+        TrackerRemove(i);
+        return true;
+    }
+    if (r->kind != EDIT_SET) {
+        char *name = TextPatch("", 0, 0, name_mid, r->len[to]);
+        char *desc = TextPatch("", 0, 0, desc_mid, r->len[2 + to]);
+        int k = name && desc ? TrackerInsert(i, name, desc, r->start[0], r->end[0]) : -1;
+        free(name);
+        free(desc);
+        if (k < 0) return false;
+        tracker.color[k] = r->color;
+        JournalAdd(k);
+        return true;
+    }
+
+    if (i >= tracker.editable) return false;
+    char *name = TextPatch(EventName(i), r->name_at, r->name_tail, name_mid, r->len[to]);
+    char *desc = TextPatch(EventDesc(i), r->desc_at, r->desc_tail, desc_mid, r->len[2 + to]);
+    if (name && desc) {
+        TrackerSetText(i, name, desc);
+        tracker.start[i] = r->start[to];
+        tracker.end[i]   = r->end[to];
+        IndexMoved(i);
+        JournalSet(i);
+    }
+    free(name);
+    free(desc);
+    return name && desc;
+}
+
+// Steps back one edit. *touched gets the event it left in place, or -1 when
+// that step removed one. False when there is nothing to undo.
+bool HistoryUndo(int *touched)
+{
+    HistoryFlush();
+    if (history.cursor == 0) return false;
+    const EditRecord *r = HistoryAt(history.cursor - 1);
+    if (!EditApply(r, 0)) { HistoryClear(); return false; }
+    history.cursor--;
+    *touched = r->kind == EDIT_ADD ? -1 : r->i;
+    return true;
+}
+
+bool HistoryRedo(int *touched)
+{
+    HistoryFlush();
+    if (history.cursor == history.count) return false;
+    const EditRecord *r = HistoryAt(history.cursor);
+    if (!EditApply(r, 1)) { HistoryClear(); return false; }
+    history.cursor++;
+    *touched = r->kind == EDIT_DELETE ? -1 : r->i;
+    return true;
+}
+
+void HistoryClear(void)
+{
+    history.pending = -1;
+    free(history.pending_name);
+    free(history.pending_desc);
+    history.pending_name = history.pending_desc = NULL;
+    HistoryForget();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Layers – more timeline files shown over the main one, read-only. Each is
+// parsed into a private store by a small thread pool while the main thread
+// loads the timeline itself (snapshot + journal); then they're moved into the
+// tracker in one pass, so startup costs about what the largest file does
+// rather than the sum of all of them.
+// ─────────────────────────────────────────────────────────────────────────────
+static const EventColor LAYER_COLORS[] = {
+    {230, 120, 100, 255}, {100, 180, 230, 255}, {140, 210, 120, 255}, {220, 180,  90, 255},
+    {190, 130, 220, 255}, { 90, 200, 190, 255}, {230, 140, 190, 255}, {170, 170, 170, 255},
+};
+
+typedef struct {
+    const char *file;
+    Tracker store;
+} LayerJob;
+
+typedef struct {
+    LayerJob *jobs;
+    int count;
+    atomic_int next;
+} LayerPool;
+
+static void *LayerWorker(void *arg)
+{
+    LayerPool *pool = arg;
+    for (int k; (k = atomic_fetch_add(&pool->next, 1)) < pool->count; ) {
+        LayerJob *job = &pool->jobs[k];
+        size_t size = 0;
+        bool mapped = false;
+        const char *data = MapFile(job->file, &size, &mapped);
+        if (!data) { Warn("Could not read %s", job->file); continue; }
+        ParseTimelineJson(job->file, data, size, &job->store, true);
+        UnmapFile(data, size, mapped);
+    }
+    return NULL;
+}
+
+// Moves a worker's events to the end of the tracker as layer k. Times come in as
+// wall-clock seconds; strings are interned into the tracker's arena, so names
+// the files have in common are stored once.
+static void MergeLayer(Tracker *src, int k)
+{
+    if (!TrackerReserve(tracker.count + src->count)) {
+        Warn("Out of memory loading %s", layers[k].name);
+        TrackerFreeCopy(src);
+        return;
+    }
+    for (int j = 0; j < src->count; j++) {
+        time_t s = UtcFromLocal(src->start[j]), e = UtcFromLocal(src->end[j]);
+        if (!s || e <= s) continue;
+        TextId n = TextIntern(&tracker.text, src->text.data + src->name[j]);
+        TextId d = TextIntern(&tracker.text, src->text.data + src->desc[j]);
+        if (n == TEXT_NONE || d == TEXT_NONE) { Warn("Out of memory loading %s", layers[k].name); break; }
+        int i = tracker.count++;
+        tracker.start[i] = s;
+        tracker.end[i]   = e;
+        tracker.track[i] = 0;
+        tracker.color[i] = layers[k].color;
+        tracker.layer[i] = (unsigned char)k;
+        tracker.name[i]  = n;
+        tracker.desc[i]  = d;
+    }
+    tracker.text.live = tracker.text.used;
+    TrackerFreeCopy(src);
+}
+
+// "dir/work.json" -> "work"
+static void LayerName(char *out, size_t size, const char *file)
+{
+    const char *base = strrchr(file, '/');
+    base = base ? base + 1 : file;
+    const char *dot = strrchr(base, '.');
+    int len = dot && dot != base ? (int)(dot - base) : (int)strlen(base);
+    snprintf(out, size, "%.*s", len, base);
+}
+
+// Opens `json` as the editable timeline (see LoadTimeline) with the n files in
+// `overlays` on top of it as read-only layers 1..n
+void LoadTimelines(const char *json, const char *const *overlays, int n)
+{
+    if (n > MAX_LAYERS - 1) {
+        Warn("Only the first %d overlay files are loaded", MAX_LAYERS - 1);
+        n = MAX_LAYERS - 1;
+    }
+    if (n < 0) n = 0;
+
+    LayerJob jobs[MAX_LAYERS] = {0};
+    layer_count = 1 + n;
+    layers[0] = (TimelineLayer){0};
+    LayerName(layers[0].name, sizeof(layers[0].name), json);
+    for (int k = 0; k < n; k++) {
+        jobs[k].file = overlays[k];
+        layers[k+1] = (TimelineLayer){ .color = LAYER_COLORS[k % (sizeof(LAYER_COLORS) / sizeof(LAYER_COLORS[0]))] };
+        LayerName(layers[k+1].name, sizeof(layers[k+1].name), overlays[k]);
+    }
+
+    // One core stays with the main timeline; once that's loaded the main thread
+    // helps with whatever files are left
+    LayerPool pool = { jobs, n, 0 };
+    pthread_t workers[MAX_LAYERS];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int want = cpus > 1 ? (int)(cpus - 1) : 0, started = 0;
+    if (want > n) want = n;
+    while (started < want && pthread_create(&workers[started], NULL, LayerWorker, &pool) == 0) started++;
+
+    HistoryClear();
+    LoadTimeline(json);
+    LayerWorker(&pool);
+    for (int w = 0; w < started; w++) pthread_join(workers[w], NULL);
+
+    if (n > 0) {
+        IndexMarkDirty();
+        SearchReset();
+        for (int k = 0; k < n; k++) MergeLayer(&jobs[k].store, k + 1);
+    }
+    IndexEnsure();
+    SearchEnsure();
+}
+
+// Hidden layers keep their events but give up their tracks, so what's left
+// stacks as if they weren't loaded
+void LayerSetHidden(int layer, bool hidden)
+{
+    if (layer < 0 || layer >= layer_count || layers[layer].hidden == hidden) return;
+    layers[layer].hidden = hidden;
+    if (!ev_index.dirty && ev_index.count > 0) LayoutRange(0, ev_index.count - 1);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Import – CSV time sheets and iCalendar (.ics) VEVENTs become events of the
+// timeline itself. The mapped file is cut into IMPORT_CHUNK pieces; a piece's
+// records are the ones starting between the first record boundary at or after
+// its offset and the next piece's, so every core can find its own start
+// without reading what comes before. Pieces parse into private stores with
+// wall-clock times (as overlay layers do), get appended in file order, and the
+// whole import is saved at once instead of journaled record by record.
+// ─────────────────────────────────────────────────────────────────────────────
+#define IMPORT_CHUNK     (4u << 20)   // bytes per parse job
+#define IMPORT_THREADS   64
+#define IMPORT_UTC_START 1            // a piece's track column holds these flags:
+#define IMPORT_UTC_END   2            // which of its times are UTC rather than wall clock
+#define CSV_MAX_COLUMNS  256
+
+typedef struct {
+    const char *lo;    // nominal start
+    size_t quotes;     // CSV: '"' bytes in [lo, next lo)
+    bool in_quotes;    // CSV: lo sits inside a quoted field
+    int skipped;       // records without a usable start and end
+    bool oom;
+    Tracker store;
+} ImportChunk;
+
+typedef struct ImportJobs ImportJobs;
+struct ImportJobs {
+    const char *begin, *end;   // the records (a CSV header already skipped)
+    ImportChunk *chunks;
+    int count;
+    CsvColumns cols;
+    void (*run)(ImportJobs *jobs, int k);
+    atomic_int next;
+};
+
+static void *ImportWorker(void *arg)
+{
+    ImportJobs *jobs = arg;
+    for (int k; (k = atomic_fetch_add(&jobs->next, 1)) < jobs->count; ) jobs->run(jobs, k);
+    return NULL;
+}
+
+// Calls run(jobs, k) for every piece on all cores, this thread included
+static void ImportRun(ImportJobs *jobs, void (*run)(ImportJobs *, int))
+{
+    jobs->run = run;
+    atomic_store(&jobs->next, 0);
+    pthread_t workers[IMPORT_THREADS];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int want = cpus > 1 ? (int)(cpus - 1) : 0, started = 0;
+    if (want > jobs->count - 1) want = jobs->count - 1;
+    if (want > IMPORT_THREADS) want = IMPORT_THREADS;
+    while (started < want && pthread_create(&workers[started], NULL, ImportWorker, jobs) == 0) started++;
+    ImportWorker(jobs);
+    for (int w = 0; w < started; w++) pthread_join(workers[w], NULL);
+}
+
+static bool ImportSplit(ImportJobs *jobs)
+{
+    size_t size = (size_t)(jobs->end - jobs->begin);
+    jobs->count = size > 0 ? (int)((size + IMPORT_CHUNK - 1) / IMPORT_CHUNK) : 1;
+    jobs->chunks = calloc((size_t)jobs->count, sizeof(ImportChunk));
+    if (!jobs->chunks) return false;
+    for (int k = 0; k < jobs->count; k++) jobs->chunks[k].lo = jobs->begin + (size_t)k * IMPORT_CHUNK;
+    return true;
+}
+
+static const char *ChunkHi(const ImportJobs *jobs, int k)
+{
+    return k + 1 < jobs->count ? jobs->chunks[k+1].lo : jobs->end;
+}
+
+// Appends the pieces to the timeline's own events in file order, then saves.
+// Returns how many events were added; the pieces are freed either way.
+static int ImportMerge(const char *file, ImportJobs *jobs)
+{
+    int total = 0, skipped = 0, first = tracker.editable;
+    bool oom = false;
+    for (int k = 0; k < jobs->count; k++) {
+        total += jobs->chunks[k].store.count;
+        skipped += jobs->chunks[k].skipped;
+        oom |= jobs->chunks[k].oom;
+    }
+
+    // Too many events for per-event index and search upkeep; rebuild both once
+    IndexMarkDirty();
+    SearchReset();
+    HistoryClear();   // older records don't know about the imported events
+    if (!TrackerReserve(tracker.count + total)) oom = true;
+    for (int k = 0; k < jobs->count && !oom; k++) {
+        Tracker *src = &jobs->chunks[k].store;
+        for (int j = 0; j < src->count; j++) {
+            int flags = src->track[j];
+            time_t s = flags & IMPORT_UTC_START ? src->start[j] : UtcFromLocal(src->start[j]);
+            time_t e = flags & IMPORT_UTC_END   ? src->end[j]   : UtcFromLocal(src->end[j]);
+            if (!s || e <= s) { skipped++; continue; }
+            TextId n = TextIntern(&tracker.text, src->text.data + src->name[j]);
+            TextId d = TextIntern(&tracker.text, src->text.data + src->desc[j]);
+            if (n == TEXT_NONE || d == TEXT_NONE) { oom = true; break; }
+
+            // The first overlay event makes room, as in TrackerInsert
+            int i = tracker.editable;
+            if (i < tracker.count) TrackerMove(i, tracker.count);
+            tracker.count++;
+            tracker.editable++;
+            tracker.start[i] = s;
+            tracker.end[i]   = e;
+            tracker.track[i] = 0;
+            tracker.color[i] = (EventColor){RandomValue(90,230), RandomValue(90,230), RandomValue(110,240), 255};
+            tracker.layer[i] = 0;
+            tracker.name[i]  = n;
+            tracker.desc[i]  = d;
+        }
+    }
+    for (int k = 0; k < jobs->count; k++) TrackerFreeCopy(&jobs->chunks[k].store);
+    free(jobs->chunks);
+    jobs->chunks = NULL;
+
+    tracker.text.live = tracker.text.used;
+    text_generation++;
+    IndexEnsure();
+    if (oom) Warn("Out of memory importing %s", file);
+    if (skipped) Warn("%s: skipped %d records without a usable start and end", file, skipped);
+
+    // If the files can't be written, fall back to journaling every event
+    if (tracker.editable > first && !JournalCheckpoint())
+        for (int i = first; i < tracker.editable; i++) JournalAdd(i);
+    return tracker.editable - first;
+}
+
+// ── CSV ──────────────────────────────────────────────────────────────────────
+// RFC 4180: fields may be quoted, quotes inside double up, and quoted fields
+// may hold separators and line breaks. That makes the quote parity at a piece's
+// offset the one thing a worker can't see locally, so a first pass counts
+// quotes per piece and a prefix sum hands every piece its starting state.
+enum { CSV_NAME, CSV_DESC, CSV_START, CSV_END, CSV_ROLES };
+
+static const struct { const char *header; int role; } CSV_HEADERS[] = {
+    { "name", CSV_NAME }, { "title", CSV_NAME }, { "summary", CSV_NAME }, { "subject", CSV_NAME }, { "task", CSV_NAME },
+    { "desc", CSV_DESC }, { "description", CSV_DESC }, { "notes", CSV_DESC }, { "details", CSV_DESC },
+    { "start", CSV_START }, { "begin", CSV_START }, { "from", CSV_START }, { "start time", CSV_START }, { "start date", CSV_START },
+    { "end", CSV_END }, { "finish", CSV_END }, { "to", CSV_END }, { "until", CSV_END }, { "end time", CSV_END }, { "end date", CSV_END },
+};
+
+// Appends the field at *p to out (skipped when out is NULL) and moves past it.
+// True when another field of the same record follows.
+static bool CsvField(const char **pp, const char *end, char sep, StrBuf *out)
+{
+    const char *p = *pp;
+    if (p < end && *p == '"') {
+        for (p++;;) {
+            const char *q = memchr(p, '"', (size_t)(end - p));
+            if (!q) q = end;
+            if (out) StrBufAppend(out, p, (size_t)(q - p));
+            p = q < end ? q + 1 : end;
+            if (p >= end || *p != '"') break;
+            if (out) StrBufAppend(out, "\"", 1);
+            p++;
+        }
+    }
+    // Unquoted text, or whatever trails a closing quote
+    const char *q = p;
+    while (q < end && *q != sep && *q != '\n') q++;
+    size_t n = (size_t)(q - p);
+    if (n > 0 && p[n-1] == '\r' && (q == end || *q == '\n')) n--;
+    if (out) StrBufAppend(out, p, n);
+    *pp = q < end ? q + 1 : end;
+    return q < end && *q == sep;
+}
+
+// The most common of ',', ';' and tab on the first line
+static char CsvGuessSeparator(const char *p, const char *end)
+{
+    static const char seps[3] = { ',', ';', '\t' };
+    int n[3] = {0}, best = 0;
+    bool quoted = false;
+    for (; p < end && (quoted || *p != '\n'); p++) {
+        if (*p == '"') quoted = !quoted;
+        else if (!quoted) for (int k = 0; k < 3; k++) n[k] += *p == seps[k];
+    }
+    for (int k = 1; k < 3; k++) if (n[k] > n[best]) best = k;
+    return seps[best];
+}
+
+// Fills the columns still at -1 from the header's names; returns the first record
+static const char *CsvHeader(const char *p, const char *end, CsvColumns *cols)
+{
+    int *column[CSV_ROLES] = { &cols->name, &cols->desc, &cols->start, &cols->end };
+    bool given[CSV_ROLES];
+    for (int r = 0; r < CSV_ROLES; r++) given[r] = *column[r] >= 0;
+
+    StrBuf cell = {0};
+    bool more = true;
+    for (int f = 0; more; f++) {
+        cell.len = 0;
+        StrBufAppend(&cell, "", 0);
+        more = CsvField(&p, end, cols->sep, &cell);
+        if (!cell.data) break;
+
+        char *h = cell.data;
+        while (*h == ' ') h++;
+        size_t n = strlen(h);
+        while (n > 0 && h[n-1] == ' ') h[--n] = '\0';
+        for (size_t k = 0; k < sizeof(CSV_HEADERS) / sizeof(CSV_HEADERS[0]); k++) {
+            int r = CSV_HEADERS[k].role;
+            if (!given[r] && *column[r] < 0 && strcasecmp(h, CSV_HEADERS[k].header) == 0) *column[r] = f;
+        }
+    }
+    free(cell.data);
+    return p;
+}
+
+// Start and end cells: whatever ParseDateTime takes, plus ISO 8601's 'T'
+static bool CsvTime(const char *s, int64_t *local)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s", s);
+    if (strlen(buf) > 10 && buf[10] == 'T') buf[10] = ' ';
+    return ParseWallClock(buf, local);
+}
+
+static void CsvCountQuotes(ImportJobs *jobs, int k)
+{
+    size_t n = 0;
+    const char *p = jobs->chunks[k].lo, *hi = ChunkHi(jobs, k);
+    while (p < hi && (p = memchr(p, '"', (size_t)(hi - p)))) { n++; p++; }
+    jobs->chunks[k].quotes = n;
+}
+
+// Where piece k's records begin: just past the first line break outside quotes
+static const char *CsvBoundary(const ImportJobs *jobs, int k)
+{
+    if (k == 0) return jobs->begin;
+    if (k >= jobs->count) return jobs->end;
+    bool quoted = jobs->chunks[k].in_quotes;
+    for (const char *p = jobs->chunks[k].lo; p < jobs->end; p++) {
+        if (*p == '"') quoted = !quoted;
+        else if (*p == '\n' && !quoted) return p + 1;
+    }
+    return jobs->end;
+}
+
+static void CsvParseChunk(ImportJobs *jobs, int k)
+{
+    ImportChunk *chunk = &jobs->chunks[k];
+    const char *p = CsvBoundary(jobs, k), *hi = CsvBoundary(jobs, k + 1);
+    const int role_column[CSV_ROLES] = { jobs->cols.name, jobs->cols.desc, jobs->cols.start, jobs->cols.end };
+    StrBuf cell[CSV_ROLES] = {0};
+    StrBuf *column[CSV_MAX_COLUMNS] = {0};
+    int columns = 0;
+    for (int r = 0; r < CSV_ROLES; r++) {
+        if (role_column[r] < 0) continue;
+        column[role_column[r]] = &cell[r];
+        if (role_column[r] >= columns) columns = role_column[r] + 1;
+    }
+
+    while (p < hi) {
+        const char *record = p;
+        for (int r = 0; r < CSV_ROLES; r++) { cell[r].len = 0; StrBufAppend(&cell[r], "", 0); }
+        for (int f = 0; CsvField(&p, hi, jobs->cols.sep, f < columns ? column[f] : NULL); f++) {}
+        if (*record == '\n' || (*record == '\r' && p - record <= 2)) continue;   // blank line
+
+        int64_t s, e;
+        const char *name = cell[CSV_NAME].data, *desc = cell[CSV_DESC].data;
+        if (!cell[CSV_START].data || !cell[CSV_END].data ||
+            !CsvTime(cell[CSV_START].data, &s) || !CsvTime(cell[CSV_END].data, &e) || e <= s) {
+            chunk->skipped++;
+            continue;
+        }
+        if (StoreAppend(&chunk->store, name ? name : "", desc ? desc : "", (time_t)s, (time_t)e) < 0) {
+            chunk->oom = true;
+            break;
+        }
+    }
+    for (int r = 0; r < CSV_ROLES; r++) free(cell[r].data);
+}
+
+// Imports a CSV file into the timeline's own events. cols picks the columns;
+// with cols->header set, the first line is skipped and any column left at -1
+// is looked up by name there. Returns the number of events added, or -1.
+int ImportCsv(const char *file, const CsvColumns *cols)
+{
+    size_t size = 0;
+    bool mapped = false;
+    const char *data = MapFile(file, &size, &mapped);
+    if (!data) { Warn("Could not read %s", file); return -1; }
+
+    ImportJobs jobs = { .begin = data, .end = data + size, .cols = *cols };
+    // A UTF-8 byte order mark would stick to the first header name
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) jobs.begin += 3;
+    if (!jobs.cols.sep) jobs.cols.sep = CsvGuessSeparator(jobs.begin, jobs.end);
+    if (jobs.cols.header) jobs.begin = CsvHeader(jobs.begin, jobs.end, &jobs.cols);
+
+    if (jobs.cols.start < 0 || jobs.cols.end < 0 ||
+        jobs.cols.start >= CSV_MAX_COLUMNS || jobs.cols.end >= CSV_MAX_COLUMNS ||
+        jobs.cols.name >= CSV_MAX_COLUMNS || jobs.cols.desc >= CSV_MAX_COLUMNS) {
+        Warn("%s: no usable start and end columns", file);
+        UnmapFile(data, size, mapped);
+        return -1;
+    }
+    if (!ImportSplit(&jobs)) {
+        Warn("Out of memory importing %s", file);
+        UnmapFile(data, size, mapped);
+        return -1;
+    }
+
+    ImportRun(&jobs, CsvCountQuotes);
+    bool quoted = false;
+    for (int k = 0; k < jobs.count; k++) {
+        jobs.chunks[k].in_quotes = quoted;
+        quoted ^= jobs.chunks[k].quotes & 1;
+    }
+    ImportRun(&jobs, CsvParseChunk);
+    UnmapFile(data, size, mapped);
+    return ImportMerge(file, &jobs);
+}
+
+// ── iCalendar ────────────────────────────────────────────────────────────────
+// RFC 5545 content lines, folded at 75 bytes by a line break plus a space or
+// tab. Line breaks never appear inside a value, so any line that is exactly
+// "BEGIN:VEVENT" starts a record. Only the first occurrence of a recurring
+// event is imported, and TZID times are read as local wall-clock time.
+
+// Next content line with its continuation lines joined; false at the end
+static bool IcsLine(const char **pp, const char *end, StrBuf *line)
+{
+    const char *p = *pp;
+    if (p >= end) return false;
+    line->len = 0;
+    StrBufAppend(line, "", 0);
+    for (;;) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p)), *stop = nl ? nl : end;
+        size_t n = (size_t)(stop - p);
+        if (n > 0 && p[n-1] == '\r') n--;
+        StrBufAppend(line, p, n);
+        p = nl ? nl + 1 : end;
+        if (p >= end || (*p != ' ' && *p != '\t')) break;
+        p++;
+    }
+    *pp = p;
+    return line->data != NULL;
+}
+
+// True when the line is property `name`, with or without parameters
+static bool IcsProperty(const char *line, const char *name)
+{
+    size_t n = strlen(name);
+    return strncasecmp(line, name, n) == 0 && (line[n] == ';' || line[n] == ':');
+}
+
+// The value: everything after the first ':' outside a quoted parameter
+static const char *IcsValue(const char *line)
+{
+    bool quoted = false;
+    for (const char *p = line; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        else if (*p == ':' && !quoted) return p + 1;
+    }
+    return NULL;
+}
+
+static bool IcsDigits(const char **p, int n, int *out)
+{
+    int v = 0;
+    for (; n > 0; n--, (*p)++) {
+        if (**p < '0' || **p > '9') return false;
+        v = v * 10 + (**p - '0');
+    }
+    *out = v;
+    return true;
+}
+
+// DATE "20240115" or DATE-TIME "20240115T093000", which is UTC with a trailing
+// 'Z' and wall-clock time otherwise
+static bool IcsTime(const char *v, int64_t *t, bool *utc, bool *date_only)
+{
+    int y, m, d, hh = 0, mm = 0, ss = 0;
+    if (!IcsDigits(&v, 4, &y) || !IcsDigits(&v, 2, &m) || !IcsDigits(&v, 2, &d) ||
+        m < 1 || m > 12 || d < 1 || d > 31) return false;
+    *date_only = *v != 'T';
+    if (!*date_only) {
+        v++;
+        if (!IcsDigits(&v, 2, &hh) || !IcsDigits(&v, 2, &mm) || !IcsDigits(&v, 2, &ss) ||
+            hh > 23 || mm > 59 || ss > 60) return false;
+    }
+    *utc = !*date_only && *v == 'Z';
+    *t = DaysFromCivil(y, m, d) * 86400 + hh * 3600 + mm * 60 + ss;
+    return true;
+}
+
+// "PT1H30M", "P1D", "P2W", "-PT15M" -> seconds
+static bool IcsDuration(const char *v, int64_t *secs)
+{
+    int64_t sign = 1, total = 0;
+    if (*v == '+' || *v == '-') sign = *v++ == '-' ? -1 : 1;
+    if (*v++ != 'P') return false;
+    bool in_time = false, any = false;
+    while (*v) {
+        if (*v == 'T') { in_time = true; v++; continue; }
+        int64_t n = 0;
+        if (*v < '0' || *v > '9') return false;
+        while (*v >= '0' && *v <= '9' && n < 1000000000) n = n * 10 + (*v++ - '0');
+        char unit = *v++;
+        if      (unit == 'W' && !in_time) total += n * 7 * 86400;
+        else if (unit == 'D' && !in_time) total += n * 86400;
+        else if (unit == 'H' && in_time)  total += n * 3600;
+        else if (unit == 'M' && in_time)  total += n * 60;
+        else if (unit == 'S' && in_time)  total += n;
+        else return false;
+        any = true;
+    }
+    *secs = sign * total;
+    return any;
+}
+
+// TEXT values escape line breaks as \n and commas, semicolons, backslashes with '\'
+static void IcsText(const char *v, StrBuf *out)
+{
+    out->len = 0;
+    StrBufAppend(out, "", 0);
+    for (const char *p = v; *p; ) {
+        const char *bs = strchr(p, '\\');
+        if (!bs) { StrBufAppend(out, p, strlen(p)); break; }
+        StrBufAppend(out, p, (size_t)(bs - p));
+        char c = bs[1];
+        if (c == 'n' || c == 'N') StrBufAppend(out, "\n", 1);
+        else if (c) StrBufAppend(out, &c, 1);
+        p = c ? bs + 2 : bs + 1;
+    }
+}
+
+// Where piece k's records begin: at its first "BEGIN:VEVENT" line
+static const char *IcsBoundary(const ImportJobs *jobs, int k)
+{
+    if (k == 0) return jobs->begin;
+    if (k >= jobs->count) return jobs->end;
+    const char *p = jobs->chunks[k].lo - 1;
+    for (;;) {
+        const char *q = memmem(p, (size_t)(jobs->end - p), "\nBEGIN:VEVENT", 13);
+        if (!q) return jobs->end;
+        q += 13;
+        if (q == jobs->end || *q == '\r' || *q == '\n') return q - 12;
+        p = q;
+    }
+}
+
+static void IcsParseChunk(ImportJobs *jobs, int k)
+{
+    ImportChunk *chunk = &jobs->chunks[k];
+    const char *p = IcsBoundary(jobs, k), *hi = IcsBoundary(jobs, k + 1);
+    StrBuf line = {0}, name = {0}, desc = {0};
+    int depth = 0;   // 1 inside a VEVENT, more inside its VALARMs
+    int64_t s = 0, e = 0, duration = 0;
+    bool has_start = false, has_end = false, has_duration = false;
+    bool utc_start = false, utc_end = false, date_start = false, date_end = false;
+
+    while (IcsLine(&p, hi, &line)) {
+        const char *v = IcsValue(line.data);
+        if (!v) continue;
+
+        if (IcsProperty(line.data, "BEGIN")) {
+            if (depth > 0) depth++;
+            else if (strcasecmp(v, "VEVENT") == 0) {
+                depth = 1;
+                has_start = has_end = has_duration = false;
+                IcsText("", &name);
+                IcsText("", &desc);
+            }
+            continue;
+        }
+        if (IcsProperty(line.data, "END")) {
+            if (depth == 0 || --depth > 0) continue;
+            if (!has_start) { chunk->skipped++; continue; }
+            if (!has_end) {
+                // RFC 5545: a DATE start alone lasts the day, a DATE-TIME start alone is an instant
+                e = s + (has_duration ? duration : date_start ? 86400 : 0);
+                utc_end = utc_start;
+            }
+            if (utc_start == utc_end && e <= s) { chunk->skipped++; continue; }
+            int i = StoreAppend(&chunk->store, name.data ? name.data : "", desc.data ? desc.data : "", (time_t)s, (time_t)e);
+            if (i < 0) { chunk->oom = true; break; }
+            chunk->store.track[i] = (utc_start ? IMPORT_UTC_START : 0) | (utc_end ? IMPORT_UTC_END : 0);
+            continue;
+        }
+        if (depth != 1) continue;
+
+        if      (IcsProperty(line.data, "SUMMARY"))     IcsText(v, &name);
+        else if (IcsProperty(line.data, "DESCRIPTION")) IcsText(v, &desc);
+        else if (IcsProperty(line.data, "DTSTART"))     has_start = IcsTime(v, &s, &utc_start, &date_start);
+        else if (IcsProperty(line.data, "DTEND"))       has_end = IcsTime(v, &e, &utc_end, &date_end);
+        else if (IcsProperty(line.data, "DURATION"))    has_duration = IcsDuration(v, &duration);
+    }
+    free(line.data); free(name.data); free(desc.data);
+}
+
+// Imports the VEVENTs of an .ics file into the timeline's own events; returns
+// the number added, or -1
+int ImportIcs(const char *file)
+{
+    size_t size = 0;
+    bool mapped = false;
+    const char *data = MapFile(file, &size, &mapped);
+    if (!data) { Warn("Could not read %s", file); return -1; }
+
+    ImportJobs jobs = { .begin = data, .end = data + size };
+    if (!ImportSplit(&jobs)) {
+        Warn("Out of memory importing %s", file);
+        UnmapFile(data, size, mapped);
+        return -1;
+    }
+    ImportRun(&jobs, IcsParseChunk);
+    UnmapFile(data, size, mapped);
+    return ImportMerge(file, &jobs);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PNG writer – streams an RGB image to disk a band of rows at a time, so an
+// export can be far larger than anything held in memory. Every row gets the
+// PNG filter (none, sub or up) with the smallest sum of magnitudes, then goes
+// through a small deflate: one fixed-Huffman block, greedy matches from a
+// one-entry hash table. Rendered timelines are mostly flat color and repeated
+// rows, which come out of the filters as long zero runs; that is all this
+// needs to compress well, so zlib isn't worth a dependency.
+// ─────────────────────────────────────────────────────────────────────────────
+#define PNG_WINDOW    32768          // deflate's longest match distance
+#define PNG_HASH_BITS 15
+#define PNG_IDAT      (256u << 10)   // bytes per IDAT chunk
+
+struct PngWriter {
+    FILE *f;
+    int width, height, rows;        // rows: written so far
+    size_t stride;                  // 3 bytes per pixel
+    unsigned char *prev, *cur, *line;
+    unsigned char *window;          // last PNG_WINDOW bytes compressed, then the bytes being compressed
+    size_t window_len;
+    int32_t *hash;                  // window position of the last 4 bytes with this hash, -1 if none
+    uint64_t bits;
+    int nbits;
+    uint32_t adler;
+    unsigned char *out;             // deflate output not yet in an IDAT chunk
+    size_t out_len;
+    bool ok;
+};
+
+static const uint16_t LEN_BASE[29]   = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const uint8_t  LEN_EXTRA[29]  = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const uint16_t DIST_BASE[30]  = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const uint8_t  DIST_EXTRA[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+// Fixed Huffman codes, already bit-reversed for the LSB-first stream
+static struct { uint16_t code[288]; uint8_t len[288]; uint8_t len_code[259]; bool ready; } png_codes;
+
+static uint32_t ReverseBits(uint32_t v, int n)
+{
+    uint32_t r = 0;
+    while (n-- > 0) { r = r << 1 | (v & 1); v >>= 1; }
+    return r;
+}
+
+static void PngBuildCodes(void)
+{
+    if (png_codes.ready) return;
+    for (int s = 0; s < 288; s++) {
+        int len = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+        int code = s < 144 ? 0x30 + s : s < 256 ? 0x190 + s - 144 : s < 280 ? s - 256 : 0xC0 + s - 280;
+        png_codes.code[s] = (uint16_t)ReverseBits((uint32_t)code, len);
+        png_codes.len[s] = (uint8_t)len;
+    }
+    for (int n = 3, c = 0; n <= 258; n++) {
+        while (c < 28 && LEN_BASE[c+1] <= n) c++;
+        png_codes.len_code[n] = (uint8_t)c;
+    }
+    png_codes.ready = true;
+}
+
+static void PngPut32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)(v >> 24); p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);  p[3] = (unsigned char)v;
+}
+
+static uint32_t Crc32(uint32_t crc, const unsigned char *p, size_t n)
+{
+    static uint32_t table[256];
+    if (!table[1])
+        for (uint32_t k = 0; k < 256; k++) {
+            uint32_t c = k;
+            for (int b = 0; b < 8; b++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[k] = c;
+        }
+    crc = ~crc;
+    while (n--) crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t Adler32(uint32_t adler, const unsigned char *p, size_t n)
+{
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (n > 0) {
+        size_t run = n < 5552 ? n : 5552;   // largest run before the sums can overflow
+        n -= run;
+        while (run--) { a += *p++; b += a; }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+
+static void PngChunk(PngWriter *w, const char *type, const unsigned char *data, size_t n)
+{
+    unsigned char head[8], tail[4];
+    PngPut32(head, (uint32_t)n);
+    memcpy(head + 4, type, 4);
+    PngPut32(tail, Crc32(Crc32(0, head + 4, 4), data, n));
+    w->ok = w->ok && WriteAll(w->f, head, 8) && WriteAll(w->f, data, n) && WriteAll(w->f, tail, 4);
+}
+
+static void PngBits(PngWriter *w, uint32_t value, int count)
+{
+    w->bits |= (uint64_t)value << w->nbits;
+    w->nbits += count;
+    while (w->nbits >= 8) {
+        w->out[w->out_len++] = (unsigned char)w->bits;
+        w->bits >>= 8;
+        w->nbits -= 8;
+        if (w->out_len == PNG_IDAT) { PngChunk(w, "IDAT", w->out, w->out_len); w->out_len = 0; }
+    }
+}
+
+static void PngSymbol(PngWriter *w, int s) { PngBits(w, png_codes.code[s], png_codes.len[s]); }
+
+static void PngMatch(PngWriter *w, size_t len, size_t dist)
+{
+    int c = png_codes.len_code[len];
+    PngSymbol(w, 257 + c);
+    if (LEN_EXTRA[c]) PngBits(w, (uint32_t)(len - LEN_BASE[c]), LEN_EXTRA[c]);
+    int d = 0;
+    while (d < 29 && DIST_BASE[d+1] <= dist) d++;
+    PngBits(w, ReverseBits((uint32_t)d, 5), 5);
+    if (DIST_EXTRA[d]) PngBits(w, (uint32_t)(dist - DIST_BASE[d]), DIST_EXTRA[d]);
+}
+
+static uint32_t PngHash(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return (v * 2654435761u) >> (32 - PNG_HASH_BITS);
+}
+
+// Codes window bytes [from, to); matches may reach back into what came before
+static void PngCompress(PngWriter *w, size_t from, size_t to)
+{
+    const unsigned char *b = w->window;
+    for (size_t i = from; i < to; ) {
+        size_t len = 0, dist = 0;
+        if (i + 4 <= to) {
+            uint32_t h = PngHash(b + i);
+            int32_t cand = w->hash[h];
+            w->hash[h] = (int32_t)i;
+            if (cand >= 0 && i - (size_t)cand <= PNG_WINDOW && memcmp(b + cand, b + i, 3) == 0) {
+                size_t max = to - i < 258 ? to - i : 258;
+                len = 3;
+                while (len < max && b[cand + len] == b[i + len]) len++;
+                dist = i - (size_t)cand;
+            }
+        }
+        if (len) { PngMatch(w, len, dist); i += len; }
+        else PngSymbol(w, b[i++]);
+    }
+}
+
+static void PngDeflate(PngWriter *w, const unsigned char *data, size_t n)
+{
+    w->adler = Adler32(w->adler, data, n);
+    while (n > 0) {
+        if (w->window_len == 2 * PNG_WINDOW) {
+            // Keep the last window's worth as match history
+            memmove(w->window, w->window + PNG_WINDOW, PNG_WINDOW);
+            w->window_len = PNG_WINDOW;
+            for (size_t h = 0; h < (1u << PNG_HASH_BITS); h++)
+                w->hash[h] = w->hash[h] >= PNG_WINDOW ? w->hash[h] - PNG_WINDOW : -1;
+        }
+        size_t take = 2 * PNG_WINDOW - w->window_len;
+        if (take > n) take = n;
+        memcpy(w->window + w->window_len, data, take);
+        PngCompress(w, w->window_len, w->window_len + take);
+        w->window_len += take;
+        data += take;
+        n -= take;
+    }
+}
+
+// Creates the file and writes the header; NULL if that fails
+PngWriter *PngBegin(const char *file, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > (INT32_MAX - 1) / 3) return NULL;
+    PngWriter *w = calloc(1, sizeof(PngWriter));
+    if (!w) return NULL;
+    w->width = width;
+    w->height = height;
+    w->stride = (size_t)width * 3;
+    w->prev = calloc(w->stride, 1);
+    w->cur = malloc(w->stride);
+    w->line = malloc(w->stride + 1);
+    w->window = malloc(2 * PNG_WINDOW);
+    w->hash = malloc(sizeof(int32_t) << PNG_HASH_BITS);
+    w->out = malloc(PNG_IDAT);
+    w->f = fopen(file, "wb");
+    w->adler = 1;
+    w->ok = w->prev && w->cur && w->line && w->window && w->hash && w->out && w->f;
+    if (!w->ok) { PngEnd(w); return NULL; }
+    PngBuildCodes();
+    memset(w->hash, 0xFF, sizeof(int32_t) << PNG_HASH_BITS);
+
+    unsigned char ihdr[13] = {0};
+    PngPut32(ihdr, (uint32_t)width);
+    PngPut32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;   // bits per channel
+    ihdr[9] = 2;   // RGB
+    w->ok = WriteAll(w->f, "\x89PNG\r\n\x1a\n", 8);
+    PngChunk(w, "IHDR", ihdr, sizeof(ihdr));
+
+    // zlib header, then a single final block with fixed codes
+    w->out[w->out_len++] = 0x78;
+    w->out[w->out_len++] = 0x01;
+    PngBits(w, 1, 1);
+    PngBits(w, 1, 2);
+    return w;
+}
+
+// Appends `rows` rows of RGBA pixels (width * 4 bytes each); alpha is dropped
+bool PngWriteRows(PngWriter *w, const unsigned char *rgba, int rows)
+{
+    if (!w || w->rows + rows > w->height) return false;
+    for (int r = 0; r < rows && w->ok; r++, rgba += (size_t)w->width * 4) {
+        unsigned char *cur = w->cur, *prev = w->prev, *line = w->line;
+        for (size_t x = 0, k = 0; k < w->stride; x += 4, k += 3) {
+            cur[k] = rgba[x]; cur[k+1] = rgba[x+1]; cur[k+2] = rgba[x+2];
+        }
+        uint64_t sum[3] = {0};
+        for (size_t k = 0; k < w->stride; k++) {
+            int left = k >= 3 ? cur[k-3] : 0;
+            sum[0] += (uint64_t)abs((signed char)cur[k]);
+            sum[1] += (uint64_t)abs((signed char)(cur[k] - left));
+            sum[2] += (uint64_t)abs((signed char)(cur[k] - prev[k]));
+        }
+        int type = sum[1] < sum[0] ? 1 : 0;
+        if (sum[2] < sum[type]) type = 2;
+
+        line[0] = (unsigned char)type;
+        for (size_t k = 0; k < w->stride; k++) {
+            int left = k >= 3 ? cur[k-3] : 0;
+            line[k+1] = (unsigned char)(type == 0 ? cur[k] : type == 1 ? cur[k] - left : cur[k] - prev[k]);
+        }
+        PngDeflate(w, line, w->stride + 1);
+        w->prev = cur;
+        w->cur = prev;
+        w->rows++;
+    }
+    return w->ok;
+}
+
+// Finishes the stream, closes the file and frees w. False if a write failed or
+// fewer rows than promised came in; removing the file is up to the caller.
+bool PngEnd(PngWriter *w)
+{
+    if (!w) return false;
+    bool ok = w->ok && w->rows == w->height;
+    if (ok) {
+        PngSymbol(w, 256);
+        if (w->nbits > 0) PngBits(w, 0, 8 - w->nbits);
+        unsigned char adler[4];
+        PngPut32(adler, w->adler);
+        for (int k = 0; k < 4; k++) PngBits(w, adler[k], 8);
+        if (w->out_len) PngChunk(w, "IDAT", w->out, w->out_len);
+        PngChunk(w, "IEND", NULL, 0);
+        ok = w->ok;
+    }
+    if (w->f && fclose(w->f) != 0) ok = false;
+    free(w->prev); free(w->cur); free(w->line); free(w->window); free(w->hash); free(w->out);
+    free(w);
+    return ok;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Queries – what the command line answers without a window: events overlapping
+// [from, to], covered time per name and overlapping pairs, as JSON or TSV.
+// All three walk IndexQuery's hits, which come sorted by start, so each is one
+// pass over the events in range rather than over the whole store.
+// ─────────────────────────────────────────────────────────────────────────────
+// "YYYY-MM-DD HH:MM" in local time, like the timeline file, without the
+// localtime_r call per field
+static void FormatLocal(time_t t, char out[20])
+{
+    int64_t local = (int64_t)t + ZoneOffsetAt(t);
+    int64_t days = FloorDiv(local, 86400), secs = local - days * 86400;
+    int y, m, d;
+    CivilFromDays(days, &y, &m, &d);
+    snprintf(out, 20, "%04d-%02d-%02d %02d:%02d", y, m, d, (int)(secs / 3600), (int)(secs / 60 % 60));
+}
+
+// TSV has no quoting, so the separators inside a field are escaped C-style
+static void WriteTsvField(FILE *f, const char *s)
+{
+    for (; *s; s++) {
+        if (*s == '\t')      fputs("\\t", f);
+        else if (*s == '\n') fputs("\\n", f);
+        else if (*s == '\r') fputs("\\r", f);
+        else if (*s == '\\') fputs("\\\\", f);
+        else fputc(*s, f);
+    }
+}
+
+// Same object the timeline file holds, so `events` output loads as a timeline
+static void WriteEventJson(FILE *f, int i)
+{
+    char s1[20], s2[20];
+    FormatLocal(tracker.start[i], s1);
+    FormatLocal(tracker.end[i], s2);
+    fputs("{\"name\":\"", f);
+    WriteEscaped(f, EventName(i));
+    fprintf(f, "\",\"start\":\"%s\",\"end\":\"%s\",\"desc\":\"", s1, s2);
+    WriteEscaped(f, EventDesc(i));
+    fputs("\"}", f);
+}
+
+// Every event with start <= to and end >= from. Returns how many were written.
+int QueryEvents(FILE *out, time_t from, time_t to, bool tsv)
+{
+    int n = IndexQuery(from, to, 0);
+    fputs(tsv ? "start\tend\tname\tdesc\n" : "[", out);
+    for (int h = 0; h < n; h++) {
+        int i = ev_index.hits[h];
+        if (tsv) {
+            char s1[20], s2[20];
+            FormatLocal(tracker.start[i], s1);
+            FormatLocal(tracker.end[i], s2);
+            fprintf(out, "%s\t%s\t", s1, s2);
+            WriteTsvField(out, EventName(i));
+            fputc('\t', out);
+            WriteTsvField(out, EventDesc(i));
+            fputc('\n', out);
+        } else {
+            fputs(h ? ",\n  " : "\n  ", out);
+            WriteEventJson(out, i);
+        }
+    }
+    if (!tsv) fputs(n ? "\n]\n" : "]\n", out);
+    return n;
+}
+
+typedef struct {
+    TextId name;
+    int    events;
+    time_t covered;   // seconds of [from, to] under at least one of its events
+    time_t until;     // end of the covered part so far
+} NameTotal;
+
+static int CompareTotals(const void *a, const void *b)
+{
+    const NameTotal *x = a, *y = b;
+    if (x->covered != y->covered) return x->covered < y->covered ? 1 : -1;
+    return strcmp(tracker.text.data + x->name, tracker.text.data + y->name);
+}
+
+// Slot of `name` in an open-addressing table of indices into totals (-1: empty).
+// Names are interned, so equal handles are equal strings.
+static int *TotalsSlot(int *table, int slots, const NameTotal *totals, TextId name)
+{
+    uint32_t h = name * 0x9E3779B1u;
+    size_t slot = (h ^ (h >> 15)) & (slots - 1);
+    while (table[slot] >= 0 && totals[table[slot]].name != name) slot = (slot + 1) & (slots - 1);
+    return &table[slot];
+}
+
+// Time covered per name inside [from, to]: overlapping events of the same name
+// count once, so a name never gets more than to - from. Sorted by time, most
+// first. Returns the number of names, or -1 on OOM.
+int QueryTotals(FILE *out, time_t from, time_t to, bool tsv)
+{
+    int n = IndexQuery(from, to, 0);
+    int slots = 64;
+    while (slots < n * 2) slots *= 2;
+    NameTotal *totals = malloc((n ? n : 1) * sizeof(NameTotal));
+    int *table = malloc(slots * sizeof(int));
+    if (!totals || !table) { free(totals); free(table); Warn("Out of memory for totals"); return -1; }
+    memset(table, 0xFF, slots * sizeof(int));
+
+    // Clipped starts stay in start order, so per name the union only ever grows
+    // at its right end
+    int names = 0;
+    for (int h = 0; h < n; h++) {
+        int i = ev_index.hits[h];
+        time_t s = tracker.start[i] > from ? tracker.start[i] : from;
+        time_t e = tracker.end[i] < to ? tracker.end[i] : to;
+        if (e <= s) continue;
+        int *slot = TotalsSlot(table, slots, totals, tracker.name[i]);
+        if (*slot < 0) {
+            totals[names] = (NameTotal){ tracker.name[i], 0, 0, s };
+            *slot = names++;
+        }
+        NameTotal *t = &totals[*slot];
+        t->events++;
+        if (e > t->until) {
+            t->covered += e - (s > t->until ? s : t->until);
+            t->until = e;
+        }
+    }
+    free(table);
+    qsort(totals, names, sizeof(NameTotal), CompareTotals);
+
+    fputs(tsv ? "name\tseconds\thours\tevents\n" : "[", out);
+    for (int k = 0; k < names; k++) {
+        const NameTotal *t = &totals[k];
+        const char *name = tracker.text.data + t->name;
+        if (tsv) {
+            WriteTsvField(out, name);
+            fprintf(out, "\t%lld\t%.2f\t%d\n", (long long)t->covered, t->covered / 3600.0, t->events);
+        } else {
+            fputs(k ? ",\n  {\"name\":\"" : "\n  {\"name\":\"", out);
+            WriteEscaped(out, name);
+            fprintf(out, "\",\"seconds\":%lld,\"hours\":%.2f,\"events\":%d}", (long long)t->covered, t->covered / 3600.0, t->events);
+        }
+    }
+    if (!tsv) fputs(names ? "\n]\n" : "]\n", out);
+    free(totals);
+    return names;
+}
+
+// Every pair of events that overlap for a positive stretch inside [from, to],
+// with that stretch. A sweep over the hits keeps the events still running, so
+// the cost is the events in range plus the pairs reported. Returns the number
+// of pairs, or -1 on OOM.
+int QueryConflicts(FILE *out, time_t from, time_t to, bool tsv)
+{
+    int n = IndexQuery(from, to, 0);
+    int *active = malloc((n ? n : 1) * sizeof(int)), live = 0, pairs = 0;
+    if (!active) { Warn("Out of memory for conflicts"); return -1; }
+
+    fputs(tsv ? "from\tto\tseconds\tfirst\tsecond\n" : "[", out);
+    for (int h = 0; h < n; h++) {
+        int i = ev_index.hits[h];
+        time_t s = tracker.start[i] > from ? tracker.start[i] : from;
+
+        // Drop what ended by the time i starts; the rest all overlap i
+        int kept = 0;
+        for (int k = 0; k < live; k++)
+            if (tracker.end[active[k]] > tracker.start[i]) active[kept++] = active[k];
+        live = kept;
+
+        for (int k = 0; k < live; k++) {
+            int j = active[k];
+            time_t e = tracker.end[i] < tracker.end[j] ? tracker.end[i] : tracker.end[j];
+            if (e > to) e = to;
+            if (e <= s) continue;
+
+            char s1[20], s2[20];
+            FormatLocal(s, s1);
+            FormatLocal(e, s2);
+            if (tsv) {
+                fprintf(out, "%s\t%s\t%lld\t", s1, s2, (long long)(e - s));
+                WriteTsvField(out, EventName(j));
+                fputc('\t', out);
+                WriteTsvField(out, EventName(i));
+                fputc('\n', out);
+            } else {
+                fprintf(out, "%s{\"from\":\"%s\",\"to\":\"%s\",\"seconds\":%lld,\"events\":[",
+                        pairs ? ",\n  " : "\n  ", s1, s2, (long long)(e - s));
+                WriteEventJson(out, j);
+                fputc(',', out);
+                WriteEventJson(out, i);
+                fputs("]}", out);
+            }
+            pairs++;
+        }
+        active[live++] = i;
+    }
+    if (!tsv) fputs(pairs ? "\n]\n" : "]\n", out);
+    free(active);
+    return pairs;
+}
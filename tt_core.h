@@ -0,0 +1,183 @@
+#ifndef TT_CORE_H
+#define TT_CORE_H
+// Everything the tracker does that doesn't need a window: the event store and
+// its layers, the interval index and track layout, the level-of-detail pyramid,
+// the trigram search index, calendar math and date parsing, JSON / snapshot /
+// journal persistence, CSV and iCalendar import, PNG encoding, undo history,
+// hit-testing and the command-line queries. Builds without raylib, which is
+// what lets bench/tt_bench.c measure it headless:
+//
+//   cc -O2 -o timeTracker timeTracker.c tt_core.c -lraylib -lm -lpthread
+//   cc -O2 -o tt_bench bench/tt_bench.c tt_core.c -lm -lpthread
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#define TIME_MIN ((time_t)INT64_MIN)
+
+// Same layout as raylib's Color, so snapshots stay byte-compatible
+typedef struct { unsigned char r, g, b, a; } EventColor;
+
+// Byte offset of a string in its store's text arena (see the string arena
+// section of tt_core.c); equal text, equal handle
+typedef uint32_t TextId;
+
+typedef struct {
+    char    *data;
+    uint32_t used, capacity;
+    uint32_t live;           // bytes in use after the last load or compaction
+    TextId  *table;          // interning hash table, open addressing
+    uint32_t slots, count;
+} TextArena;
+
+// Event store: one column per field, index i is the same event in every array.
+// The per-frame passes only touch start/end/track, so those stay packed; the
+// strings live in the arena and are only followed for tooltips and saving.
+// Events [0, editable) are the timeline file's own; read-only overlay layers
+// follow them.
+typedef struct {
+    time_t *start, *end;
+    int    *track;          // -1 while the event's layer is hidden
+    EventColor *color;
+    unsigned char *layer;   // index into layers[]
+    TextId *name, *desc;    // see EventName / EventDesc
+    TextArena text;
+    int count, capacity;
+    int editable;
+    time_t view_start; double pixels_per_year;
+} Tracker;
+
+// Layer 0 is the timeline being edited, the rest are files opened on top of it
+#define MAX_LAYERS 16
+
+typedef struct {
+    char name[64];
+    EventColor color;   // bar color for an overlay's events
+    bool hidden;
+} TimelineLayer;
+
+// Sorted view of the store, see the interval index section of tt_core.c
+typedef struct {
+    int    *order;      // event indices sorted by (start, index)
+    int    *pos;        // inverse of order: pos[order[p]] == p
+    time_t *max_end;    // subtree max end, parallel to order
+    time_t *max_len;    // subtree max end - start, parallel to order (see IndexQuery)
+    time_t *run_end;    // prefix max end, parallel to order
+    int    *hits;       // result buffer for IndexQuery
+    int     count, capacity;
+    int     max_level;
+    bool    dirty;      // bulk edits set this; the next IndexEnsure rebuilds everything
+} IntervalIndex;
+
+#define LOD_BASE_SHIFT 12         // ~68 min buckets at level 0
+#define LOD_LEVELS     10         // up to ~24 days, enough for the widest zoom
+#define LOD_HEADER     0xFFFFFF   // track field of a bucket's header cell
+
+typedef struct {
+    uint64_t key;
+    uint32_t count;     // events starting in the bucket; max track + 1 in a header
+    uint32_t covered;   // seconds of the bucket covered by them
+} LodCell;
+
+// Where the timeline sits on screen, for hit-testing
+typedef struct {
+    time_t view_start;
+    double pixels_per_year;
+    float  width;         // bars are clipped to [0, width)
+    float  rows_y;        // y of track 0
+    float  row_spacing;
+} TimelineView;
+
+extern Tracker tracker;
+extern IntervalIndex ev_index;
+extern unsigned text_generation;   // bumped whenever event strings change or move
+extern TimelineLayer layers[MAX_LAYERS];
+extern int layer_count;
+
+// Calendar
+void    CivilFromDays(int64_t z, int *y, int *m, int *d);
+time_t  UtcFromLocal(int64_t local);
+time_t  LocalFromCivil(int y, int m, int d, int hour, int min);
+int64_t LocalCivil(time_t t, int *y, int *m, int *d);
+time_t  ParseDateTime(const char *s);
+
+// Event store
+bool   GrowColumn(void *column, size_t elem_size, int cap);
+int    TrackerAdd(const char *name, const char *desc, time_t s, time_t e);
+int    TrackerInsert(int i, const char *name, const char *desc, time_t s, time_t e);
+void   TrackerRemove(int i);
+void   TrackerSetText(int i, const char *name, const char *desc);
+const char *EventName(int i);
+const char *EventDesc(int i);
+void   TrackerClear(void);
+double DurationYears(int i);
+
+// Interval index and track layout
+void IndexMarkDirty(void);
+void IndexEnsure(void);
+void IndexMoved(int i);
+int  IndexQuery(time_t from, time_t to, time_t min_len);
+int  EventPick(const TimelineView *v, float x, float y);
+
+// Level of detail
+uint64_t       LodKey(int level, int track, int64_t bucket);
+const LodCell *LodFind(uint64_t key);
+time_t         LodBucketSecs(int level);
+int            LodLevelFor(double secs_per_px);
+
+// Full-text search
+void SearchEnsure(void);
+int  SearchQuery(const char *query, int *hits, int max_hits);
+bool SearchPartial(void);
+
+// Undo history
+void HistoryAdded(int i);
+void HistoryRemoving(int i);
+void HistoryEditing(int i);
+void HistoryFlush(void);
+bool HistoryUndo(int *touched);
+bool HistoryRedo(int *touched);
+void HistoryClear(void);
+
+// Persistence
+void     SaveTracker(const char *file);
+void     LoadTracker(const char *file);
+void     LoadTimeline(const char *json);
+bool     PeekTimeline(const char *json, bool drawn);
+void     CloseTimeline(void);
+void     LoadTimelines(const char *json, const char *const *overlays, int n);
+void     LayerSetHidden(int layer, bool hidden);
+void     JournalAdd(int i);
+void     JournalSet(int i);
+void     JournalDelete(int i);
+void     JournalPoll(void);
+bool     JournalBusy(void);
+uint64_t JournalSeq(void);
+
+// Import into the timeline's own events. CSV columns are zero-based; -1 means
+// look the column up by name in the header line.
+typedef struct {
+    int  name, desc, start, end;
+    char sep;      // 0 guesses ',', ';' or tab from the first line
+    bool header;   // the first line names the columns
+} CsvColumns;
+
+int ImportCsv(const char *file, const CsvColumns *cols);
+int ImportIcs(const char *file);
+
+// PNG export, streamed a band of rows at a time
+typedef struct PngWriter PngWriter;
+
+PngWriter *PngBegin(const char *file, int width, int height);
+bool       PngWriteRows(PngWriter *w, const unsigned char *rgba, int rows);
+bool       PngEnd(PngWriter *w);
+
+// Command-line queries over [from, to], written as JSON or TSV (see the queries
+// section of tt_core.c). Each returns the rows written, or -1 on OOM.
+int QueryEvents(FILE *out, time_t from, time_t to, bool tsv);
+int QueryTotals(FILE *out, time_t from, time_t to, bool tsv);
+int QueryConflicts(FILE *out, time_t from, time_t to, bool tsv);
+
+#endif